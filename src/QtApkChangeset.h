@@ -1,6 +1,7 @@
 #ifndef H_QTAPK_CHANGESET
 #define H_QTAPK_CHANGESET
 
+#include <QString>
 #include <QVector>
 #include "QtApkPackage.h"
 
@@ -13,6 +14,14 @@ namespace QtApk {
 /**
  * @class ChangesetItem
  * @brief Single change withing a Changeset
+ *
+ * Items are standalone copies and stay valid after the database
+ * is closed. Only compact information is filled in: name, versions
+ * and sizes, and oldPackage/newPackage contain only name, version
+ * and arch. Full package information can be obtained on demand with
+ * Database::findPackage() or Database::findInstalled().
+ * oldPackage is empty if package is going to be installed,
+ * newPackage is empty if it is going to be removed.
  */
 class QTAPK_EXPORTS ChangesetItem
 {
@@ -22,6 +31,13 @@ public:
     Package oldPackage;
     Package newPackage;
     bool reinstall = false;
+
+    QString name;                  //! package name
+    QString oldVersion;            //! empty if package is going to be installed
+    QString newVersion;            //! empty if package is going to be removed
+    quint64 oldInstalledSize = 0;
+    quint64 newInstalledSize = 0;
+    quint64 downloadSize = 0;      //! 0 if package does not need to be downloaded
 };
 
 /**
@@ -40,9 +56,16 @@ public:
     int numRemove() const { return m_numRemove; }
     int numAdjust() const { return m_numAdjust; }
 
+    //! total bytes to download from repositories
+    quint64 downloadSize() const { return m_downloadSize; }
+    //! change of disk space used by installed packages, in bytes
+    qint64 installedSizeDelta() const { return m_installedSizeDelta; }
+
     void setNumInstall(int n) { m_numInstall = n; }
     void setNumRemove(int n) { m_numRemove = n; }
     void setNumAdjust(int n) { m_numAdjust = n; }
+    void setDownloadSize(quint64 sz) { m_downloadSize = sz; }
+    void setInstalledSizeDelta(qint64 delta) { m_installedSizeDelta = delta; }
 
     QVector<ChangesetItem> &changes() { return m_changes; }
     const QVector<ChangesetItem> &changes() const { return m_changes; }
@@ -51,6 +74,8 @@ protected:
     int m_numInstall = 0;
     int m_numRemove = 0;
     int m_numAdjust = 0;
+    quint64 m_downloadSize = 0;
+    qint64 m_installedSizeDelta = 0;
     QVector<ChangesetItem> m_changes;
 };
 
@@ -107,23 +107,52 @@ bool Database::isOpen() const
 }
 
 
-bool Database::updatePackageIndex(DbUpdateFlags flags)
+bool Database::updatePackageIndex(DbUpdateFlags flags, QVector<RepositoryUpdateResult> *results)
 {
     Q_D(Database);
-    return d->update(flags);
+    return d->update(flags, results);
+}
+
+void Database::setIndexMaxAge(int seconds)
+{
+    Q_D(Database);
+    d->set_index_max_age(seconds);
+}
+
+int Database::indexMaxAge() const
+{
+    Q_D(const Database);
+    return d->index_max_age();
+}
+
+QMap<QString, QDateTime> Database::repositoryRefreshTimes() const
+{
+    Q_D(const Database);
+    return d->repository_refresh_times();
 }
 
 int Database::upgradeablePackagesCount()
 {
     Q_D(Database);
-    int totalUpgrades = 0;
-    Changeset changes;
+    return d->upgradeable_packages_count();
+}
 
-    if (d->upgrade(QTAPK_UPGRADE_SIMULATE, &changes)) {
-        // Don't count packages to remove
-        totalUpgrades = changes.numInstall() + changes.numAdjust();
-    }
-    return totalUpgrades;
+QVector<UpgradeablePackage> Database::getUpgradeablePackages() const
+{
+    Q_D(const Database);
+    return d->get_upgradeable_packages();
+}
+
+DependencyGraph Database::getInstalledDependencyGraph() const
+{
+    Q_D(const Database);
+    return d->get_installed_dependency_graph();
+}
+
+DependencyGraph Database::getAvailableDependencyGraph() const
+{
+    Q_D(const Database);
+    return d->get_available_dependency_graph();
 }
 
 bool Database::upgrade(DbUpgradeFlags flags, Changeset *changes)
@@ -144,16 +173,94 @@ bool Database::del(const QString &packageNameSpec, DbDelFlags flags)
     return d->del(packageNameSpec, flags);
 }
 
-QVector<Package> Database::getInstalledPackages() const
+bool Database::add(const QStringList &packageNameSpecs, DbAddFlags flags, Changeset *changes)
+{
+    Q_D(Database);
+    return d->add(packageNameSpecs, flags, changes);
+}
+
+bool Database::del(const QStringList &packageNameSpecs, DbDelFlags flags, Changeset *changes)
+{
+    Q_D(Database);
+    return d->del(packageNameSpecs, flags, changes);
+}
+
+Plan Database::prepareUpgrade(DbUpgradeFlags flags)
+{
+    Q_D(Database);
+    return d->prepare_upgrade(flags);
+}
+
+Plan Database::prepareAdd(const QStringList &packageNameSpecs)
+{
+    Q_D(Database);
+    return d->prepare_add(packageNameSpecs);
+}
+
+Plan Database::prepareDel(const QStringList &packageNameSpecs, DbDelFlags flags)
+{
+    Q_D(Database);
+    return d->prepare_del(packageNameSpecs, flags);
+}
+
+QVector<Package> Database::getInstalledPackages(PackageFields fields) const
+{
+    Q_D(const Database);
+    return d->get_installed_packages(fields);
+}
+
+QVector<Package> Database::getAvailablePackages(PackageFields fields, DbQueryFlags qflags) const
+{
+    Q_D(const Database);
+    return d->get_available_packages(fields, qflags);
+}
+
+QVector<Package> Database::findPackage(const QString &name, PackageFields fields) const
+{
+    Q_D(const Database);
+    return d->find_package(name, fields);
+}
+
+Package Database::findInstalled(const QString &name, PackageFields fields) const
+{
+    Q_D(const Database);
+    return d->find_installed(name, fields);
+}
+
+QVector<PackageView> Database::search(const QString &query, int limit) const
 {
     Q_D(const Database);
-    return d->get_installed_packages();
+    return d->search(query, limit);
 }
 
-QVector<Package> Database::getAvailablePackages() const
+QStringList Database::completeName(const QString &prefix, int limit) const
 {
     Q_D(const Database);
-    return d->get_available_packages();
+    return d->complete_name(prefix, limit);
+}
+
+QVector<PackageView> Database::getInstalledPackageViews() const
+{
+    Q_D(const Database);
+    return d->get_installed_package_views();
+}
+
+QVector<PackageView> Database::getAvailablePackageViews() const
+{
+    Q_D(const Database);
+    return d->get_available_package_views();
+}
+
+int Database::forEachInstalledPackage(const PackageVisitor &visitor) const
+{
+    Q_D(const Database);
+    return d->for_each_installed_package(visitor);
+}
+
+int Database::forEachAvailablePackage(const PackageVisitor &visitor) const
+{
+    Q_D(const Database);
+    return d->for_each_available_package(visitor);
 }
 
 int Database::progressFd() const
@@ -162,4 +269,10 @@ int Database::progressFd() const
     return d->progressFd();
 }
 
+void Database::setDownloadProgressCallback(const DownloadProgressCallback &cb)
+{
+    Q_D(Database);
+    d->set_download_progress_callback(cb);
+}
+
 } // namespace QtApk
@@ -3,12 +3,22 @@
 #ifndef H_QTAPKDATABASE
 #define H_QTAPKDATABASE
 
+#include <QDateTime>
+#include <QMap>
 #include <QString>
+#include <QStringList>
 #include <QVector>
+#include <functional>
 #include "QtApkFlags.h"
 #include "QtApkPackage.h"
+#include "QtApkPackageView.h"
+#include "QtApkPlan.h"
 #include "QtApkRepository.h"
+#include "QtApkRepositoryUpdateResult.h"
+#include "QtApkUpgradeablePackage.h"
 #include "QtApkChangeset.h"
+#include "QtApkDependencyGraph.h"
+#include "QtApkDownloadProgress.h"
 
 #include "qtapk_exports.h"
 
@@ -17,6 +27,21 @@ namespace QtApk {
 
 class DatabasePrivate;
 
+/**
+ * @brief PackageVisitor
+ * Function called for each package by Database::forEachInstalledPackage()
+ * and Database::forEachAvailablePackage(). Return true to continue
+ * enumeration, false to stop it.
+ */
+typedef std::function<bool(const PackageView &pkg)> PackageVisitor;
+
+/**
+ * @brief DownloadProgressCallback
+ * Function called with byte-level progress of each download,
+ * see Database::setDownloadProgressCallback()
+ */
+typedef std::function<void(const DownloadProgress &progress)> DownloadProgressCallback;
+
 /**
  * @class Database
  * @brief Main interface to interact with Alpine Package Keeper.
@@ -97,27 +122,90 @@ public:
     /**
      * @brief updatePackageIndex
      * Updates all packages repositories. Database needs to be
-     * opened for writing.
+     * opened for writing. Indexes are fetched in parallel by worker
+     * processes, so the update takes as long as the slowest mirror.
      * @param flags update flags, @see DbUpdateFlags
+     * @param results - optional output, one record per repository,
+     *                  in order of repositories configuration
      * @return true, if all was OK.
      */
-    bool updatePackageIndex(DbUpdateFlags flags = QTAPK_UPDATE_DEFAULT);
+    bool updatePackageIndex(DbUpdateFlags flags = QTAPK_UPDATE_DEFAULT,
+                            QVector<RepositoryUpdateResult> *results = nullptr);
+
+    /**
+     * @brief setIndexMaxAge
+     * Sets freshness policy for updatePackageIndex(): repositories
+     * whose cached index is younger than that are skipped, older
+     * ones are only downloaded if index was modified on server
+     * (where transport allows conditional fetch, like HTTP).
+     * Use QTAPK_UPDATE_FORCE update flag to ignore max age once.
+     * @param seconds - max index age, -1 to use libapk's default (4 hours)
+     */
+    void setIndexMaxAge(int seconds);
+
+    /**
+     * @brief indexMaxAge
+     * @return max index age in seconds, or -1 for libapk's default
+     */
+    int indexMaxAge() const;
+
+    /**
+     * @brief repositoryRefreshTimes
+     * Database needs to be opened for reading.
+     * @return repository URL => time when its index was last
+     *         refreshed (modification time of cached index file),
+     *         invalid QDateTime if index was never downloaded
+     */
+    QMap<QString, QDateTime> repositoryRefreshTimes() const;
     
     /**
      * @brief upgradeablePackagesCount
      * Calculates how many packages in the world can be upgraded.
      * Database needs to be opened for reading.
+     * Result is cached: solver runs again only after database
+     * state has changed (update, add, del, upgrade, reopen) or
+     * repository index files were modified.
      * @return rough number of packages that can be upgraded
      */
     int upgradeablePackagesCount();
 
+    /**
+     * @brief getUpgradeablePackages
+     * Cheap check for updates: compares version of each installed
+     * package with the best version available in repositories.
+     * Does not run the solver, so pinning and world constraints
+     * are not taken into account; use upgrade() with
+     * QTAPK_UPGRADE_SIMULATE flag to get the exact upgrade plan.
+     * Database needs to be opened for reading.
+     * @return list of (name, installed version, available version)
+     */
+    QVector<UpgradeablePackage> getUpgradeablePackages() const;
+
+    /**
+     * @brief getInstalledDependencyGraph
+     * Dependency graph of installed packages, in compressed
+     * sparse row layout, see DependencyGraph.
+     * Database needs to be opened for reading.
+     * @return graph, empty if database is not open
+     */
+    DependencyGraph getInstalledDependencyGraph() const;
+
+    /**
+     * @brief getAvailableDependencyGraph
+     * Same as getInstalledDependencyGraph(), for all packages
+     * available in repositories (including installed).
+     * @return graph, empty if database is not open
+     */
+    DependencyGraph getAvailableDependencyGraph() const;
+
     /**
      * @brief upgrade
      * Upgrade world.
      * Database needs to be opened for writing.
      * @param flags upgrade flags, @see DbUpgradeFlags
      * @param changes set of changes that apk will do to your
-     *                system during upgrade, @see Changeset
+     *                system during upgrade, @see Changeset; items
+     *                are compact, @see ChangesetItem
      * @return true if everything was OK
      */
     bool upgrade(DbUpgradeFlags flags = QTAPK_UPGRADE_DEFAULT, Changeset *changes = nullptr);
@@ -143,26 +231,190 @@ public:
      */
     bool del(const QString &packageNameSpec, DbDelFlags flags = QTAPK_DEL_DEFAULT);
 
+    /**
+     * @brief add
+     * Add several packages to world (install) at once: all of
+     * them are added to world first, then solver runs and changes
+     * are committed only once. If any spec is invalid, nothing is
+     * installed. Database needs to be opened for writing.
+     * @param packageNameSpecs - list of package name specifiers,
+     *            @see add(const QString &)
+     * @param flags - flags, @see DbAddFlags; with QTAPK_ADD_SIMULATE
+     *            only solver runs, nothing is downloaded or installed
+     * @param changes - optional, receives the list of changes
+     * @return true if everything was OK
+     */
+    bool add(const QStringList &packageNameSpecs, DbAddFlags flags = QTAPK_ADD_DEFAULT,
+             Changeset *changes = nullptr);
+
+    /**
+     * @brief del
+     * Delete several packages from world (uninstall) at once,
+     * with a single solver run and a single commit.
+     * Database needs to be opened for writing.
+     * @param packageNameSpecs - list of package names
+     * @param flags - flags, @see DbDelFlags; with QTAPK_DEL_SIMULATE
+     *            only solver runs, nothing is deleted
+     * @param changes - optional, receives the list of changes
+     * @return true if everything was OK
+     */
+    bool del(const QStringList &packageNameSpecs, DbDelFlags flags = QTAPK_DEL_DEFAULT,
+             Changeset *changes = nullptr);
+
+    /**
+     * @brief prepareUpgrade
+     * Run solver for system upgrade, but do not apply anything.
+     * Inspect Plan::changeset(), then call Plan::commit() to apply
+     * it without solving again. QTAPK_UPGRADE_SIMULATE flag
+     * is ignored here. Database needs to be opened for writing
+     * to commit the plan.
+     * @param flags - upgrade flags, @see DbUpgradeFlags
+     * @return plan, Plan::isValid() is false if solver failed
+     */
+    Plan prepareUpgrade(DbUpgradeFlags flags = QTAPK_UPGRADE_DEFAULT);
+
+    /**
+     * @brief prepareAdd
+     * Same as prepareUpgrade(), for installing packages.
+     * @param packageNameSpecs - list of package name specifiers
+     * @return plan, Plan::isValid() is false if solver failed
+     */
+    Plan prepareAdd(const QStringList &packageNameSpecs);
+
+    /**
+     * @brief prepareDel
+     * Same as prepareUpgrade(), for deleting packages.
+     * @param packageNameSpecs - list of package names
+     * @param flags - flags, @see DbDelFlags
+     * @return plan, Plan::isValid() is false if solver failed
+     */
+    Plan prepareDel(const QStringList &packageNameSpecs, DbDelFlags flags = QTAPK_DEL_DEFAULT);
+
     /**
      * @brief getInstalledPackages
+     * @param fields - which package fields to fill in, @see PackageFields
      * @return a QVector of QtApk::Package: all installed packages
      */
-    QVector<Package> getInstalledPackages() const;
+    QVector<Package> getInstalledPackages(PackageFields fields = QTAPK_FIELD_ALL) const;
 
     /**
      * @brief getInstalledPackages
+     * @param fields - which package fields to fill in, @see PackageFields
+     * @param qflags - query flags, @see DbQueryFlags
      * @return a QVector of QtApk::Package: all available packages
      */
-    QVector<Package> getAvailablePackages() const;
+    QVector<Package> getAvailablePackages(PackageFields fields = QTAPK_FIELD_ALL,
+                                          DbQueryFlags qflags = QTAPK_QUERY_DEFAULT) const;
+
+    /**
+     * @brief findPackage
+     * Looks up a name directly in package database's names
+     * hash table, without enumerating all packages. Use it to get
+     * full information about new packages of a ChangesetItem.
+     * @param name - exact package name, or a name provided by
+     *               other packages, like "so:libc.musl-x86_64.so.1"
+     * @param fields - which package fields to fill in, @see PackageFields
+     * @return all available packages providing this name (including
+     *         all versions), empty vector if there are none
+     */
+    QVector<Package> findPackage(const QString &name, PackageFields fields = QTAPK_FIELD_ALL) const;
+
+    /**
+     * @brief findInstalled
+     * Looks up a name directly in package database's names
+     * hash table, without enumerating all packages. Use it to get
+     * full information about old packages of a ChangesetItem.
+     * @param name - exact package name
+     * @param fields - which package fields to fill in, @see PackageFields
+     * @return installed package with this name, or empty Package
+     *         if it is not installed
+     */
+    Package findInstalled(const QString &name, PackageFields fields = QTAPK_FIELD_ALL) const;
+
+    /**
+     * @brief search
+     * Case-insensitive search in package names, origins and
+     * descriptions. Query is split into words, every word must
+     * match. Uses a trigram index that is built on first search
+     * and updated after updatePackageIndex().
+     * @param query - text to search for
+     * @param limit - maximum number of results
+     * @return found packages, best matches first. Views are
+     *         valid only while database is open.
+     */
+    QVector<PackageView> search(const QString &query, int limit = 50) const;
+
+    /**
+     * @brief completeName
+     * Type-ahead completion of package names. Also completes
+     * provided names, like "so:" and "cmd:" ones.
+     * @param prefix - case-sensitive name prefix, like "py3-"
+     * @param limit - maximum number of results
+     * @return sorted list of names starting with prefix
+     */
+    QStringList completeName(const QString &prefix, int limit = 20) const;
+
+    /**
+     * @brief getInstalledPackageViews
+     * Cheap variant of getInstalledPackages(): package fields are
+     * not copied, they are decoded only when read.
+     * @return a QVector of QtApk::PackageView: all installed packages.
+     *         Views are valid only while database is open.
+     */
+    QVector<PackageView> getInstalledPackageViews() const;
+
+    /**
+     * @brief getAvailablePackageViews
+     * Cheap variant of getAvailablePackages(): package fields are
+     * not copied, they are decoded only when read.
+     * @return a QVector of QtApk::PackageView: all available packages.
+     *         Views are valid only while database is open.
+     */
+    QVector<PackageView> getAvailablePackageViews() const;
+
+    /**
+     * @brief forEachInstalledPackage
+     * Streams installed packages to visitor one by one, without
+     * building any container. Enumeration stops as soon as
+     * visitor returns false.
+     * @param visitor - function to call for each package
+     * @return number of packages passed to visitor
+     */
+    int forEachInstalledPackage(const PackageVisitor &visitor) const;
+
+    /**
+     * @brief forEachAvailablePackage
+     * Streams available packages to visitor one by one, without
+     * building any container. Enumeration stops as soon as
+     * visitor returns false.
+     * @param visitor - function to call for each package
+     * @return number of packages passed to visitor
+     */
+    int forEachAvailablePackage(const PackageVisitor &visitor) const;
 
     /**
      * @brief progressFd
      * libapk has option to write operation progress into some file descriptor.
      * Format for each progress update step is "%u/%u\n"
+     * Every database has its own pipe, so several databases can be used
+     * at the same time; libapk's commits of different databases are
+     * executed one after another to keep their progress apart.
      * @return file descriptor you can select()/read() from for progress updates
      */
     int progressFd() const;
 
+    /**
+     * @brief setDownloadProgressCallback
+     * Structured, byte-level progress for downloads done by
+     * updatePackageIndex() and Plan::prefetch(), in addition to
+     * coarse steps written to progressFd(). Callback is called from
+     * the thread that called updatePackageIndex() or Plan::prefetch(),
+     * no lock is held during the call. Downloads themselves run in
+     * worker processes, so calls for several downloads never overlap.
+     * @param cb - callback, or empty function to disable reporting
+     */
+    void setDownloadProgressCallback(const DownloadProgressCallback &cb);
+
 private:
     DatabasePrivate *d_ptr = nullptr;
     Q_DECLARE_PRIVATE(Database)
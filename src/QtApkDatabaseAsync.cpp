@@ -53,12 +53,48 @@ Transaction *DatabaseAsync::updatePackageIndex(DbUpdateFlags flags)
     return d->updatePackageIndex(flags);
 }
 
+void DatabaseAsync::setIndexMaxAge(int seconds)
+{
+    Q_D(DatabaseAsync);
+    d->setIndexMaxAge(seconds);
+}
+
+int DatabaseAsync::indexMaxAge() const
+{
+    Q_D(const DatabaseAsync);
+    return d->indexMaxAge();
+}
+
+QMap<QString, QDateTime> DatabaseAsync::repositoryRefreshTimes() const
+{
+    Q_D(const DatabaseAsync);
+    return d->repositoryRefreshTimes();
+}
+
 int DatabaseAsync::upgradeablePackagesCount()
 {
     Q_D(DatabaseAsync);
     return d->upgradeablePackagesCount();
 }
 
+QVector<UpgradeablePackage> DatabaseAsync::getUpgradeablePackages() const
+{
+    Q_D(const DatabaseAsync);
+    return d->getUpgradeablePackages();
+}
+
+DependencyGraph DatabaseAsync::getInstalledDependencyGraph() const
+{
+    Q_D(const DatabaseAsync);
+    return d->getInstalledDependencyGraph();
+}
+
+DependencyGraph DatabaseAsync::getAvailableDependencyGraph() const
+{
+    Q_D(const DatabaseAsync);
+    return d->getAvailableDependencyGraph();
+}
+
 Transaction *DatabaseAsync::upgrade(DbUpgradeFlags flags, Changeset *changes)
 {
     Q_D(DatabaseAsync);
@@ -77,16 +113,77 @@ Transaction *DatabaseAsync::del(const QString &packageNameSpec, DbDelFlags flags
     return d->del(packageNameSpec, flags);
 }
 
-QVector<Package> DatabaseAsync::getInstalledPackages() const
+Transaction *DatabaseAsync::add(const QStringList &packageNameSpecs, DbAddFlags flags)
+{
+    Q_D(DatabaseAsync);
+    return d->add(packageNameSpecs, flags);
+}
+
+Transaction *DatabaseAsync::del(const QStringList &packageNameSpecs, DbDelFlags flags)
+{
+    Q_D(DatabaseAsync);
+    return d->del(packageNameSpecs, flags);
+}
+
+QVector<Package> DatabaseAsync::getInstalledPackages(PackageFields fields) const
 {
     Q_D(const DatabaseAsync);
-    return d->getInstalledPackages();
+    return d->getInstalledPackages(fields);
+}
+
+QVector<Package> DatabaseAsync::getAvailablePackages(PackageFields fields, DbQueryFlags qflags) const
+{
+    Q_D(const DatabaseAsync);
+    return d->getAvailablePackages(fields, qflags);
+}
+
+QVector<Package> DatabaseAsync::findPackage(const QString &name, PackageFields fields) const
+{
+    Q_D(const DatabaseAsync);
+    return d->findPackage(name, fields);
+}
+
+Package DatabaseAsync::findInstalled(const QString &name, PackageFields fields) const
+{
+    Q_D(const DatabaseAsync);
+    return d->findInstalled(name, fields);
+}
+
+QVector<Package> DatabaseAsync::search(const QString &query, int limit, PackageFields fields) const
+{
+    Q_D(const DatabaseAsync);
+    return d->search(query, limit, fields);
+}
+
+QStringList DatabaseAsync::completeName(const QString &prefix, int limit) const
+{
+    Q_D(const DatabaseAsync);
+    return d->completeName(prefix, limit);
+}
+
+QFuture<QVector<Package>> DatabaseAsync::getInstalledPackagesAsync(PackageFields fields) const
+{
+    Q_D(const DatabaseAsync);
+    return d->getInstalledPackagesAsync(fields);
+}
+
+QFuture<QVector<Package>> DatabaseAsync::getAvailablePackagesAsync(PackageFields fields, DbQueryFlags qflags) const
+{
+    Q_D(const DatabaseAsync);
+    return d->getAvailablePackagesAsync(fields, qflags);
+}
+
+QFuture<int> DatabaseAsync::upgradeablePackagesCountAsync()
+{
+    Q_D(DatabaseAsync);
+    return d->upgradeablePackagesCountAsync();
 }
 
-QVector<Package> DatabaseAsync::getAvailablePackages() const
+QFuture<QVector<Package>> DatabaseAsync::searchAsync(const QString &query, int limit,
+                                                    PackageFields fields) const
 {
     Q_D(const DatabaseAsync);
-    return d->getAvailablePackages();
+    return d->searchAsync(query, limit, fields);
 }
 
 
@@ -3,12 +3,18 @@
 #ifndef H_QTAPKDATABASE_ASYNC
 #define H_QTAPKDATABASE_ASYNC
 
+#include <QDateTime>
+#include <QFuture>
+#include <QMap>
 #include <QString>
+#include <QStringList>
 #include <QVector>
 #include "QtApkChangeset.h"
+#include "QtApkDependencyGraph.h"
 #include "QtApkFlags.h"
 #include "QtApkPackage.h"
 #include "QtApkRepository.h"
+#include "QtApkUpgradeablePackage.h"
 #include "QtApkTransaction.h"
 
 #include "qtapk_exports.h"
@@ -28,7 +34,19 @@ class DatabaseAsyncPrivate;
  *
  * All method calls in this class are asynchronous, operations are
  * performed in a background thread, so caller is
- * NOT blocked until return.
+ * NOT blocked until return. Any number of transactions can be
+ * started at once, they are queued, @see Transaction.
+ *
+ * Queries can be called while a transaction is running and never
+ * wait for it. getInstalledPackages(), getAvailablePackages(),
+ * findPackage(), findInstalled() and getUpgradeablePackages() then
+ * return data from a snapshot taken before the transaction started
+ * (only name, version, arch, description and sizes are filled in,
+ * whatever fields were requested; findPackage() finds only real
+ * package names, not provided ones). upgradeablePackagesCount()
+ * returns its previous result. search(), completeName() and
+ * dependency graphs return empty results, because they need
+ * the live database.
  */
 class QTAPK_EXPORTS DatabaseAsync {
 public:
@@ -70,7 +88,9 @@ public:
     bool open(DbOpenFlags flags = QTAPK_OPENF_READONLY | QTAPK_OPENF_ENABLE_PROGRESSFD);
 
     /**
-     * Close database after finishing all operations
+     * Close database. Running transaction is asked to stop and waited
+     * for; queued transactions are never executed, they emit cancelled()
+     * and finished() once control returns to their thread's event loop.
      */
     void close();
 
@@ -89,14 +109,62 @@ public:
      */
     Transaction *updatePackageIndex(DbUpdateFlags flags = QTAPK_UPDATE_DEFAULT);
 
+    /**
+     * @brief setIndexMaxAge
+     * Sets freshness policy for updatePackageIndex(),
+     * @see Database::setIndexMaxAge()
+     * @param seconds - max index age, -1 to use libapk's default (4 hours)
+     */
+    void setIndexMaxAge(int seconds);
+    int indexMaxAge() const;
+
+    /**
+     * @brief repositoryRefreshTimes
+     * @see Database::repositoryRefreshTimes()
+     * @return repository URL => time when its index was last refreshed
+     */
+    QMap<QString, QDateTime> repositoryRefreshTimes() const;
+
     /**
      * @brief upgradeablePackagesCount
      * Calculates how many packages in the world can be upgraded.
      * Database needs to be opened for reading.
+     * Result is cached: solver runs again only after database
+     * state has changed (update, add, del, upgrade, reopen) or
+     * repository index files were modified.
      * @return rough number of packages that can be upgraded
      */
     int upgradeablePackagesCount();
 
+    /**
+     * @brief getUpgradeablePackages
+     * Cheap check for updates: compares version of each installed
+     * package with the best version available in repositories.
+     * Does not run the solver, so pinning and world constraints
+     * are not taken into account; use upgrade() with
+     * QTAPK_UPGRADE_SIMULATE flag to get the exact upgrade plan.
+     * Database needs to be opened for reading.
+     * @return list of (name, installed version, available version)
+     */
+    QVector<UpgradeablePackage> getUpgradeablePackages() const;
+
+    /**
+     * @brief getInstalledDependencyGraph
+     * Dependency graph of installed packages, in compressed
+     * sparse row layout, see DependencyGraph.
+     * Database needs to be opened for reading.
+     * @return graph, empty if database is not open
+     */
+    DependencyGraph getInstalledDependencyGraph() const;
+
+    /**
+     * @brief getAvailableDependencyGraph
+     * Same as getInstalledDependencyGraph(), for all packages
+     * available in repositories (including installed).
+     * @return graph, empty if database is not open
+     */
+    DependencyGraph getAvailableDependencyGraph() const;
+
     /**
      * @brief upgrade
      * Upgrade world.
@@ -129,17 +197,126 @@ public:
      */
     Transaction *del(const QString &packageNameSpec, DbDelFlags flags = QTAPK_DEL_DEFAULT);
 
+    /**
+     * @brief add
+     * Add several packages to world (install) at once, with
+     * a single solver run and a single commit.
+     * Database needs to be opened for writing.
+     * @param packageNameSpecs - list of package name specifiers
+     * @param flags - flags, @see DbAddFlags; list of changes is
+     *            available from Transaction::changeset() after finish
+     * @return Transaction object that you can use to control background operation
+     */
+    Transaction *add(const QStringList &packageNameSpecs, DbAddFlags flags = QTAPK_ADD_DEFAULT);
+
+    /**
+     * @brief del
+     * Delete several packages from world (uninstall) at once,
+     * with a single solver run and a single commit.
+     * Database needs to be opened for writing.
+     * @param packageNameSpecs - list of package names
+     * @param flags - flags, @see DbDelFlags; list of changes is
+     *            available from Transaction::changeset() after finish
+     * @return Transaction object that you can use to control background operation
+     */
+    Transaction *del(const QStringList &packageNameSpecs, DbDelFlags flags = QTAPK_DEL_DEFAULT);
+
     /**
      * @brief getInstalledPackages
+     * @param fields - which package fields to fill in, @see PackageFields
      * @return a QVector of QtApk::Package: all installed packages
      */
-    QVector<Package> getInstalledPackages() const;
+    QVector<Package> getInstalledPackages(PackageFields fields = QTAPK_FIELD_ALL) const;
 
     /**
      * @brief getInstalledPackages
+     * @param fields - which package fields to fill in, @see PackageFields
+     * @param qflags - query flags, @see DbQueryFlags
      * @return a QVector of QtApk::Package: all available packages
      */
-    QVector<Package> getAvailablePackages() const;
+    QVector<Package> getAvailablePackages(PackageFields fields = QTAPK_FIELD_ALL,
+                                          DbQueryFlags qflags = QTAPK_QUERY_DEFAULT) const;
+
+    /**
+     * @brief findPackage
+     * Looks up a name directly in package database's names
+     * hash table, without enumerating all packages.
+     * @param name - exact package name, or a name provided by
+     *               other packages, like "so:libc.musl-x86_64.so.1"
+     * @param fields - which package fields to fill in, @see PackageFields
+     * @return all available packages providing this name (including
+     *         all versions), empty vector if there are none
+     */
+    QVector<Package> findPackage(const QString &name, PackageFields fields = QTAPK_FIELD_ALL) const;
+
+    /**
+     * @brief findInstalled
+     * Looks up a name directly in package database's names
+     * hash table, without enumerating all packages.
+     * @param name - exact package name
+     * @param fields - which package fields to fill in, @see PackageFields
+     * @return installed package with this name, or empty Package
+     *         if it is not installed
+     */
+    Package findInstalled(const QString &name, PackageFields fields = QTAPK_FIELD_ALL) const;
+
+    /**
+     * @brief search
+     * Case-insensitive search in package names, origins and
+     * descriptions. Query is split into words, every word must
+     * match. Uses a trigram index that is built on first search
+     * and updated after updatePackageIndex().
+     * @param query - text to search for
+     * @param limit - maximum number of results
+     * @param fields - which package fields to fill in, @see PackageFields
+     * @return found packages, best matches first. They are copies
+     *         made under database lock, safe to use from any thread.
+     */
+    QVector<Package> search(const QString &query, int limit = 50,
+                            PackageFields fields = QTAPK_FIELD_ALL) const;
+
+    /**
+     * @brief completeName
+     * Type-ahead completion of package names. Also completes
+     * provided names, like "so:" and "cmd:" ones.
+     * @param prefix - case-sensitive name prefix, like "py3-"
+     * @param limit - maximum number of results
+     * @return sorted list of names starting with prefix
+     */
+    QStringList completeName(const QString &prefix, int limit = 20) const;
+
+    /**
+     * @brief getInstalledPackagesAsync
+     * Same as getInstalledPackages(), but runs in a thread pool and
+     * does not block the caller. Use QFutureWatcher to get notified
+     * when result is ready.
+     * @param fields - which package fields to fill in, @see PackageFields
+     * @return future with all installed packages
+     */
+    QFuture<QVector<Package>> getInstalledPackagesAsync(PackageFields fields = QTAPK_FIELD_ALL) const;
+
+    /**
+     * @brief getAvailablePackagesAsync
+     * Same as getAvailablePackages(), runs in a thread pool.
+     * @return future with all available packages
+     */
+    QFuture<QVector<Package>> getAvailablePackagesAsync(PackageFields fields = QTAPK_FIELD_ALL,
+                                                        DbQueryFlags qflags = QTAPK_QUERY_DEFAULT) const;
+
+    /**
+     * @brief upgradeablePackagesCountAsync
+     * Same as upgradeablePackagesCount(), runs in a thread pool.
+     * @return future with rough number of packages that can be upgraded
+     */
+    QFuture<int> upgradeablePackagesCountAsync();
+
+    /**
+     * @brief searchAsync
+     * Same as search(), runs in a thread pool.
+     * @return future with found packages, best matches first
+     */
+    QFuture<QVector<Package>> searchAsync(const QString &query, int limit = 50,
+                                          PackageFields fields = QTAPK_FIELD_ALL) const;
 
 private:
     DatabaseAsyncPrivate *d_ptr = nullptr;
@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "QtApkDependencyGraph.h"
+
+#include <cstring>
+
+
+namespace QtApk {
+
+
+DependencyGraph::DependencyGraph()
+{
+    // empty graph still has a valid offsets array
+    m_offsets.append(0);
+    m_reverseOffsets.append(0);
+}
+
+QString DependencyGraph::nodeName(int node) const
+{
+    if (node < 0 || node >= nodeCount()) {
+        return QString();
+    }
+    return QString::fromUtf8(m_names.constData() + m_nameOffsets.at(node));
+}
+
+int DependencyGraph::nodeId(const QString &name) const
+{
+    const QByteArray key = name.toUtf8();
+    int lo = 0;
+    int hi = nodeCount() - 1;
+
+    while (lo <= hi) {
+        const int mid = lo + (hi - lo) / 2;
+        const int cmp = std::strcmp(m_names.constData() + m_nameOffsets.at(mid), key.constData());
+        if (cmp == 0) {
+            return mid;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return -1;
+}
+
+
+} // namespace QtApk
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef H_QTAPK_DEPENDENCY_GRAPH
+#define H_QTAPK_DEPENDENCY_GRAPH
+
+#include <QByteArray>
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+
+#include "qtapk_exports.h"
+
+namespace QtApk {
+
+class DependencyGraphBuilder;
+
+/**
+ * @brief The DependencyKind enum
+ * Kind of DependencyGraph edge, stored in DependencyGraph::kinds()
+ */
+enum DependencyKind {
+    QTAPK_DEP_DEPENDS = 0,     //! package depends on name
+    QTAPK_DEP_PROVIDES = 1,    //! package provides name (so:, cmd:, virtual packages...)
+    QTAPK_DEP_INSTALL_IF = 2,  //! package is auto-installed if name is installed
+    QTAPK_DEP_CONFLICTS = 3,   //! package conflicts with name ("!name" dependency)
+};
+
+/**
+ * @class DependencyGraph
+ * @brief Dependency graph in compressed sparse row (CSR) layout
+ *
+ * Nodes are package names, including names that only exist
+ * as something a package depends on or provides (so:libc.musl...),
+ * node ids are 0..nodeCount()-1, sorted by name.
+ * Edges go from package name to the name it depends on, provides,
+ * conflicts with or is installed together with. Several versions of
+ * the same package are merged into one node, duplicate edges are removed.
+ *
+ * Outgoing edges of node n are targets()[offsets()[n] .. offsets()[n+1]-1],
+ * with edge kind in kinds() at the same index. Reverse arrays describe
+ * incoming edges in the same way ("what depends on this name?").
+ * All arrays are flat, so graph algorithms can walk them without
+ * any allocations. Graph is a standalone copy and stays valid
+ * after the Database is closed.
+ */
+class QTAPK_EXPORTS DependencyGraph
+{
+public:
+    DependencyGraph();
+
+    bool isEmpty() const { return nodeCount() == 0; }
+    int nodeCount() const { return m_nameOffsets.size(); }
+    int edgeCount() const { return m_targets.size(); }
+
+    /**
+     * @brief nodeName
+     * @param node - node id
+     * @return package name for node id
+     */
+    QString nodeName(int node) const;
+
+    /**
+     * @brief nodeId
+     * Binary search over sorted node names.
+     * @param name - package name
+     * @return node id, or -1 if graph does not contain such name
+     */
+    int nodeId(const QString &name) const;
+
+    /**
+     * @brief isPackage
+     * @param node - node id
+     * @return true if node is a real package in this set, false
+     *         if it is only referenced by other packages
+     */
+    bool isPackage(int node) const { return m_isPackage.at(node) != 0; }
+
+    int outDegree(int node) const { return m_offsets.at(node + 1) - m_offsets.at(node); }
+    int inDegree(int node) const { return m_reverseOffsets.at(node + 1) - m_reverseOffsets.at(node); }
+
+    //! size nodeCount()+1, node n edges are in range [offsets[n], offsets[n+1])
+    const QVector<int> &offsets() const { return m_offsets; }
+    //! edge => target node id, sorted by target within each node
+    const QVector<int> &targets() const { return m_targets; }
+    //! edge => DependencyKind
+    const QVector<quint8> &kinds() const { return m_kinds; }
+
+    //! same as above, for incoming edges: reverseTargets() contain source node ids
+    const QVector<int> &reverseOffsets() const { return m_reverseOffsets; }
+    const QVector<int> &reverseTargets() const { return m_reverseTargets; }
+    const QVector<quint8> &reverseKinds() const { return m_reverseKinds; }
+
+private:
+    friend class DependencyGraphBuilder;
+
+    QByteArray m_names;           //! all node names in utf-8, '\0'-terminated
+    QVector<int> m_nameOffsets;   //! node id => offset of its name in m_names
+    QVector<quint8> m_isPackage;  //! node id => 1 if node is a package
+    QVector<int> m_offsets;
+    QVector<int> m_targets;
+    QVector<quint8> m_kinds;
+    QVector<int> m_reverseOffsets;
+    QVector<int> m_reverseTargets;
+    QVector<quint8> m_reverseKinds;
+};
+
+} // namespace QtApk
+
+Q_DECLARE_TYPEINFO(QtApk::DependencyGraph, Q_MOVABLE_TYPE);
+Q_DECLARE_METATYPE(QtApk::DependencyGraph)
+
+#endif
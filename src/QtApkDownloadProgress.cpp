@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "QtApkDownloadProgress.h"
+
+
+namespace QtApk {
+
+
+DownloadProgress::DownloadProgress()
+{
+}
+
+DownloadProgress::DownloadProgress(const QString &downloadUrl, qint64 done, qint64 total)
+{
+    url = downloadUrl;
+    bytesDone = done;
+    bytesTotal = total;
+}
+
+DownloadProgress::~DownloadProgress()
+{
+}
+
+float DownloadProgress::percent() const
+{
+    if (bytesTotal <= 0) {
+        return -1.0f;
+    }
+    return 100.0f * static_cast<float>(bytesDone) / static_cast<float>(bytesTotal);
+}
+
+
+} // namespace QtApk
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef H_QTAPK_DOWNLOAD_PROGRESS
+#define H_QTAPK_DOWNLOAD_PROGRESS
+
+#include <QObject>
+#include <QString>
+
+#include "qtapk_exports.h"
+
+namespace QtApk {
+
+/**
+ * @class DownloadProgress
+ * @brief Byte-level progress of one download
+ *
+ * Reported while repository indexes are fetched by
+ * updatePackageIndex() and while packages are downloaded by
+ * Plan::prefetch(). Several downloads may run at once, they
+ * are told apart by url.
+ */
+class QTAPK_EXPORTS DownloadProgress {
+    Q_GADGET
+    Q_PROPERTY(QString url MEMBER url)
+    Q_PROPERTY(qint64 bytesDone MEMBER bytesDone)
+    Q_PROPERTY(qint64 bytesTotal MEMBER bytesTotal)
+
+public:
+    DownloadProgress();
+    DownloadProgress(const QString &downloadUrl, qint64 done, qint64 total);
+    DownloadProgress(const DownloadProgress &other) = default;
+    DownloadProgress(DownloadProgress &&other) = default;
+    virtual ~DownloadProgress();
+
+    DownloadProgress &operator=(const DownloadProgress &other) = default;
+    DownloadProgress &operator=(DownloadProgress &&other) = default;
+
+    //! download progress in percent, or -1 if total size is not known
+    float percent() const;
+
+    QString url;            //! repository url, or package "name-version"
+    qint64 bytesDone = 0;   //! bytes downloaded so far
+    qint64 bytesTotal = -1; //! expected size: known for packages (from index),
+                            //! -1 for repository indexes
+};
+
+}
+
+Q_DECLARE_METATYPE(QtApk::DownloadProgress)
+
+#endif
@@ -27,7 +27,10 @@ Q_DECLARE_OPERATORS_FOR_FLAGS(DbOpenFlags)
  */
 enum DbUpdateFlags {
     QTAPK_UPDATE_DEFAULT = 0,            //! no flags
-    QTAPK_UPDATE_ALLOW_UNTRUSTED = 1     //! allow untrusted repository sources
+    QTAPK_UPDATE_ALLOW_UNTRUSTED = 1,    //! allow untrusted repository sources
+    QTAPK_UPDATE_FORCE = 2,              //! check all repositories, even if their cached index
+                                         //! is younger than Database::indexMaxAge(); index is still
+                                         //! only downloaded if it was modified on server
 };
 
 /**
@@ -43,6 +46,19 @@ enum DbUpgradeFlags {
                                   //! installed package is no longer available from any repository
     QTAPK_UPGRADE_LATEST = 4,     //! Select latest version of package (if it is not pinned), and print
                                   //! error if it cannot be installed due to other dependencies
+    QTAPK_UPGRADE_PREFETCH = 8,   //! Download all new packages into cache in parallel first,
+                                  //! then install them from cache. Needs package cache enabled
+};
+
+/**
+ * @brief The DbAddFlags enum
+ * Used for add() method
+ */
+enum DbAddFlags {
+    QTAPK_ADD_DEFAULT = 0,    //! no flags
+    QTAPK_ADD_SIMULATE = 1,   //! Do not install anything, only fill Changeset
+    QTAPK_ADD_PREFETCH = 2,   //! Download all new packages into cache in parallel first,
+                              //! see QTAPK_UPGRADE_PREFETCH
 };
 
 /**
@@ -51,8 +67,44 @@ enum DbUpgradeFlags {
  */
 enum DbDelFlags {
     QTAPK_DEL_DEFAULT = 0,    //! no flags
-    QTAPK_DEL_RDEPENDS = 1    //! delete package and everything that depends on it
+    QTAPK_DEL_RDEPENDS = 1,   //! delete package and everything that depends on it
+    QTAPK_DEL_SIMULATE = 2,   //! Do not delete anything, only fill Changeset
+};
+
+/**
+ * @brief The DbQueryFlags enum
+ * Used for getAvailablePackages() method
+ */
+enum DbQueryFlags {
+    QTAPK_QUERY_DEFAULT = 0,   //! no flags
+    QTAPK_QUERY_PARALLEL = 1   //! convert packages in chunks on all CPU cores
+                               //! (uses QThreadPool::globalInstance()),
+                               //! result order is the same as without this flag
+};
+
+/**
+ * @brief The PackageFields enum
+ * Used in getInstalledPackages(), getAvailablePackages() to select
+ * which Package fields should be filled in. Fields that were not
+ * requested are left empty, and cost nothing to convert.
+ */
+enum PackageFieldEnum {
+    QTAPK_FIELD_NAME = 0x1,
+    QTAPK_FIELD_VERSION = 0x2,
+    QTAPK_FIELD_ARCH = 0x4,
+    QTAPK_FIELD_LICENSE = 0x8,
+    QTAPK_FIELD_ORIGIN = 0x10,
+    QTAPK_FIELD_MAINTAINER = 0x20,
+    QTAPK_FIELD_URL = 0x40,
+    QTAPK_FIELD_DESCRIPTION = 0x80,
+    QTAPK_FIELD_COMMIT = 0x100,
+    QTAPK_FIELD_FILENAME = 0x200,
+    QTAPK_FIELD_SIZES = 0x400,      //! both size and installedSize
+    QTAPK_FIELD_BUILDTIME = 0x800,
+    QTAPK_FIELD_ALL = 0xFFF,        //! all of the above
 };
+Q_DECLARE_FLAGS(PackageFields, PackageFieldEnum)
+Q_DECLARE_OPERATORS_FOR_FLAGS(PackageFields)
 
 
 } // namespace QtApk
@@ -60,6 +112,9 @@ enum DbDelFlags {
 Q_DECLARE_METATYPE(QtApk::DbOpenFlags);
 Q_DECLARE_METATYPE(QtApk::DbUpdateFlags);
 Q_DECLARE_METATYPE(QtApk::DbUpgradeFlags);
+Q_DECLARE_METATYPE(QtApk::DbAddFlags);
 Q_DECLARE_METATYPE(QtApk::DbDelFlags);
+Q_DECLARE_METATYPE(QtApk::DbQueryFlags);
+Q_DECLARE_METATYPE(QtApk::PackageFields);
 
 #endif
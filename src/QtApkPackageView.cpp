@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "QtApkPackageView.h"
+#include "private/QtApkDatabase_private.h"
+#include "private/libapk_c_wrappers.h"
+
+
+namespace QtApk {
+
+
+PackageView::PackageView()
+{
+}
+
+PackageView::PackageView(struct apk_package *pkg)
+    : m_pkg(pkg)
+{
+}
+
+bool PackageView::isNull() const
+{
+    return m_pkg == nullptr;
+}
+
+QString PackageView::name() const
+{
+    if (!m_pkg) return QString();
+    return QString::fromUtf8(w_apk_package_get_pkg_name(m_pkg));
+}
+
+QString PackageView::version() const
+{
+    if (!m_pkg) return QString();
+    return QString::fromUtf8(w_apk_package_get_version(m_pkg));
+}
+
+QString PackageView::arch() const
+{
+    if (!m_pkg) return QString();
+    return QString::fromUtf8(w_apk_package_get_arch(m_pkg));
+}
+
+QString PackageView::license() const
+{
+    if (!m_pkg) return QString();
+    return QString::fromUtf8(w_apk_package_get_license(m_pkg));
+}
+
+QString PackageView::origin() const
+{
+    if (!m_pkg) return QString();
+    return QString::fromUtf8(w_apk_package_get_origin(m_pkg));
+}
+
+QString PackageView::maintainer() const
+{
+    if (!m_pkg) return QString();
+    return QString::fromUtf8(w_apk_package_get_maintainer(m_pkg));
+}
+
+QString PackageView::url() const
+{
+    if (!m_pkg) return QString();
+    return QString::fromUtf8(w_apk_package_get_url(m_pkg));
+}
+
+QString PackageView::description() const
+{
+    if (!m_pkg) return QString();
+    return QString::fromUtf8(w_apk_package_get_description(m_pkg));
+}
+
+QString PackageView::commit() const
+{
+    if (!m_pkg) return QString();
+    return QString::fromUtf8(w_apk_package_get_commit(m_pkg));
+}
+
+QString PackageView::filename() const
+{
+    if (!m_pkg) return QString();
+    return QString::fromUtf8(w_apk_package_get_filename(m_pkg));
+}
+
+quint64 PackageView::installedSize() const
+{
+    if (!m_pkg) return 0;
+    return w_apk_package_get_installedSize(m_pkg);
+}
+
+quint64 PackageView::size() const
+{
+    if (!m_pkg) return 0;
+    return w_apk_package_get_size(m_pkg);
+}
+
+QDateTime PackageView::buildTime() const
+{
+    if (!m_pkg) return QDateTime();
+    return QDateTime::fromSecsSinceEpoch(w_apk_package_get_buildTime(m_pkg), Qt::UTC);
+}
+
+Package PackageView::toPackage() const
+{
+    return apk_package_to_QtApkPackage(m_pkg);
+}
+
+
+} // namespace QtApk
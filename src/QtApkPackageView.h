@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef H_QTAPK_PACKAGEVIEW
+#define H_QTAPK_PACKAGEVIEW
+
+#include <QString>
+#include <QObject>
+#include <QDateTime>
+#include <QVector>
+
+#include "QtApkPackage.h"
+
+#include "qtapk_exports.h"
+
+// libapk's package record, opaque for library users
+struct apk_package;
+
+namespace QtApk {
+
+
+/**
+ * @class PackageView
+ * @brief The PackageView class
+ * Lightweight read-only view of a single package.
+ *
+ * Unlike Package, it does not copy any data when created:
+ * it only points to libapk's package record and decodes each
+ * field when it is read. Copying a PackageView is as cheap
+ * as copying a pointer.
+ *
+ * PackageView is only valid while the Database it was
+ * obtained from stays open. Use toPackage() to get a copy
+ * that can outlive the Database.
+ */
+class QTAPK_EXPORTS PackageView
+{
+    Q_GADGET
+    Q_PROPERTY(QString name READ name)
+    Q_PROPERTY(QString version READ version)
+    Q_PROPERTY(QString arch READ arch)
+    Q_PROPERTY(QString license READ license)
+    Q_PROPERTY(QString origin READ origin)
+    Q_PROPERTY(QString maintainer READ maintainer)
+    Q_PROPERTY(QString url READ url)
+    Q_PROPERTY(QString description READ description)
+    Q_PROPERTY(QString commit READ commit)
+    Q_PROPERTY(QString filename READ filename)
+    Q_PROPERTY(quint64 installedSize READ installedSize)
+    Q_PROPERTY(quint64 size READ size)
+    Q_PROPERTY(QDateTime buildTime READ buildTime)
+
+public:
+    PackageView();
+    explicit PackageView(struct apk_package *pkg);
+
+    Q_INVOKABLE bool isNull() const;
+
+    QString name() const;
+    QString version() const;
+    QString arch() const;
+    QString license() const;
+    QString origin() const;
+    QString maintainer() const;
+    QString url() const;
+    QString description() const;
+    QString commit() const;
+    QString filename() const;
+    quint64 installedSize() const;
+    quint64 size() const;
+    QDateTime buildTime() const;
+
+    /**
+     * @brief toPackage
+     * Decodes all fields at once into a standalone Package.
+     * @return package data copy, empty Package if view is null
+     */
+    Q_INVOKABLE QtApk::Package toPackage() const;
+
+    bool operator==(const PackageView &other) const { return m_pkg == other.m_pkg; }
+    bool operator!=(const PackageView &other) const { return m_pkg != other.m_pkg; }
+
+private:
+    struct apk_package *m_pkg = nullptr;
+};
+
+
+} // namespace QtApk
+
+Q_DECLARE_TYPEINFO(QtApk::PackageView, Q_MOVABLE_TYPE);
+Q_DECLARE_METATYPE(QtApk::PackageView)
+
+#endif
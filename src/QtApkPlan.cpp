@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "QtApkPlan.h"
+#include "private/QtApkPlan_private.h"
+#include "private/QtApkDatabase_private.h"
+#include "private/libapk_c_wrappers.h"
+
+#include <utility>
+
+
+namespace QtApk {
+
+
+PlanPrivate::~PlanPrivate()
+{
+    if (db) {
+        db->unregister_plan(this);
+    }
+    if (changeset) {
+        w_delete_apk_changeset(changeset);
+    }
+    if (world) {
+        w_free_world(world);
+    }
+}
+
+Plan::Plan()
+    : d_ptr(new PlanPrivate())
+{
+}
+
+Plan::Plan(PlanPrivate *dd)
+    : d_ptr(dd)
+{
+}
+
+Plan::~Plan()
+{
+    delete d_ptr;
+    d_ptr = nullptr;
+}
+
+Plan::Plan(Plan &&other)
+    : d_ptr(other.d_ptr)
+{
+    other.d_ptr = new PlanPrivate();
+}
+
+Plan &Plan::operator=(Plan &&other)
+{
+    if (this != &other) {
+        std::swap(d_ptr, other.d_ptr);
+    }
+    return *this;
+}
+
+bool Plan::isValid() const
+{
+    Q_D(const Plan);
+    return d->solved && d->db && d->db->isOpen()
+            && d->generation == d->db->current_generation();
+}
+
+const Changeset &Plan::changeset() const
+{
+    Q_D(const Plan);
+    return d->changes;
+}
+
+bool Plan::prefetch(int maxParallel)
+{
+    Q_D(Plan);
+    if (!isValid()) {
+        return false;
+    }
+    return d->db->prefetch_plan(d, maxParallel);
+}
+
+bool Plan::commit()
+{
+    Q_D(Plan);
+    if (!isValid()) {
+        return false;
+    }
+    return d->db->commit_plan(d);
+}
+
+
+} // namespace QtApk
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef H_QTAPK_PLAN
+#define H_QTAPK_PLAN
+
+#include "QtApkChangeset.h"
+
+#include "qtapk_exports.h"
+
+namespace QtApk {
+
+class DatabasePrivate;
+class PlanPrivate;
+
+/**
+ * @class Plan
+ * @brief Solved, but not yet committed set of changes
+ *
+ * Returned by Database::prepareUpgrade(), prepareAdd() and
+ * prepareDel(). Holds libapk's solver result, so the changes
+ * can be inspected with changeset() first and then applied with
+ * commit(), without running the solver again.
+ *
+ * A plan becomes invalid as soon as database state changes
+ * (any update, add, del, upgrade, another plan's commit,
+ * or database close), because the solver result may no longer
+ * be correct. Plan can only be moved, not copied.
+ */
+class QTAPK_EXPORTS Plan
+{
+public:
+    Plan();
+    ~Plan();
+    Plan(Plan &&other);
+    Plan &operator=(Plan &&other);
+
+    /**
+     * @brief isValid
+     * @return true if solver succeeded, plan was not committed yet,
+     *         and database did not change since plan was prepared
+     */
+    bool isValid() const;
+
+    /**
+     * @brief changeset
+     * @return changes that commit() will apply
+     */
+    const Changeset &changeset() const;
+
+    /**
+     * @brief prefetch
+     * Download all new packages of this plan into package cache,
+     * up to maxParallel downloads at once, so that commit() only
+     * reads them from cache. Progress is reported per package in
+     * the same way as for other operations. Package cache has to
+     * be enabled (etc/apk/cache link) and database opened for writing.
+     * Plan stays valid, changeset() download size becomes 0.
+     * Downloads run in worker processes, first failed download
+     * stops the others.
+     * @param maxParallel - max number of simultaneous downloads
+     * @return true if all packages are in cache, false if plan
+     *         is not valid or some download failed
+     */
+    bool prefetch(int maxParallel = 4);
+
+    /**
+     * @brief commit
+     * Apply prepared changes. Plan becomes invalid after that.
+     * Database needs to be opened for writing.
+     * @return true if everything was OK, false if plan is
+     *         not valid or commit failed
+     */
+    bool commit();
+
+private:
+    explicit Plan(PlanPrivate *dd);
+    friend class QtApk::DatabasePrivate;
+
+    PlanPrivate *d_ptr = nullptr;
+    Q_DECLARE_PRIVATE(Plan)
+    Q_DISABLE_COPY(Plan)
+};
+
+} // namespace QtApk
+
+#endif
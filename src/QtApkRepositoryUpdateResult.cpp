@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "QtApkRepositoryUpdateResult.h"
+#include <QDataStream>
+
+
+namespace QtApk {
+
+
+RepositoryUpdateResult::RepositoryUpdateResult()
+{
+}
+
+RepositoryUpdateResult::~RepositoryUpdateResult()
+{
+}
+
+
+} // namespace QtApk
+
+
+QDataStream &operator<<(QDataStream &stream, const QtApk::RepositoryUpdateResult &res)
+{
+    stream << res.url;
+    stream << res.status;
+    stream << res.statusString;
+    stream << res.bytesFetched;
+    stream << res.wallTimeMs;
+    stream << res.indexChanged;
+    stream << res.packageCount;
+    return stream;
+}
+
+QDataStream &operator>>(QDataStream &stream, QtApk::RepositoryUpdateResult &res)
+{
+    stream >> res.url;
+    stream >> res.status;
+    stream >> res.statusString;
+    stream >> res.bytesFetched;
+    stream >> res.wallTimeMs;
+    stream >> res.indexChanged;
+    stream >> res.packageCount;
+    return stream;
+}
+
+QDataStream &operator<<(QDataStream &stream, const QVector<QtApk::RepositoryUpdateResult> &resVec)
+{
+    stream << resVec.size();
+    for (const QtApk::RepositoryUpdateResult &res : resVec) {
+        stream << res;
+    }
+    return stream;
+}
+
+QDataStream &operator>>(QDataStream &stream, QVector<QtApk::RepositoryUpdateResult> &resVec)
+{
+    int sz = 0;
+    stream >> sz;
+    resVec.reserve(sz);
+    for (int i = 0; i < sz; i++) {
+        QtApk::RepositoryUpdateResult res;
+        stream >> res;
+        resVec.append(std::move(res));
+    }
+    return stream;
+}
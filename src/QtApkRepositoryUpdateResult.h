@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef H_QTAPK_REPOSITORY_UPDATE_RESULT
+#define H_QTAPK_REPOSITORY_UPDATE_RESULT
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include "qtapk_exports.h"
+
+class QDataStream;
+
+namespace QtApk {
+
+/**
+ * @class RepositoryUpdateResult
+ * @brief Result of index update for one repository
+ *
+ * Filled by Database::updatePackageIndex(), one record
+ * per configured repository.
+ */
+class QTAPK_EXPORTS RepositoryUpdateResult {
+    Q_GADGET
+    Q_PROPERTY(QString url MEMBER url)
+    Q_PROPERTY(int status MEMBER status)
+    Q_PROPERTY(QString statusString MEMBER statusString)
+    Q_PROPERTY(qint64 bytesFetched MEMBER bytesFetched)
+    Q_PROPERTY(qint64 wallTimeMs MEMBER wallTimeMs)
+    Q_PROPERTY(bool indexChanged MEMBER indexChanged)
+    Q_PROPERTY(int packageCount MEMBER packageCount)
+
+public:
+    RepositoryUpdateResult();
+    RepositoryUpdateResult(const RepositoryUpdateResult &other) = default;
+    RepositoryUpdateResult(RepositoryUpdateResult &&other) = default;
+    virtual ~RepositoryUpdateResult();
+
+    RepositoryUpdateResult &operator=(const RepositoryUpdateResult &other) = default;
+    RepositoryUpdateResult &operator=(RepositoryUpdateResult &&other) = default;
+
+    bool isOk() const { return status == 0; }
+
+    QString url;
+    int status = 0;            //! 0 on success, negative libapk error code on failure
+    QString statusString;      //! libapk's error text for status
+    qint64 bytesFetched = 0;   //! number of index bytes downloaded
+    qint64 wallTimeMs = 0;     //! time spent fetching this repository, in milliseconds
+    bool indexChanged = false; //! false if cached index was fresh or not modified on server
+    int packageCount = 0;      //! number of packages database has from this repository,
+                               //! -1 if index has changed: libapk loads indexes on
+                               //! open, so a new index is only counted after reopen
+};
+
+}
+
+Q_DECLARE_METATYPE(QtApk::RepositoryUpdateResult)
+
+QDataStream &operator<<(QDataStream &stream, const QtApk::RepositoryUpdateResult &res);
+QDataStream &operator>>(QDataStream &stream, QtApk::RepositoryUpdateResult &res);
+QDataStream &operator<<(QDataStream &stream, const QVector<QtApk::RepositoryUpdateResult> &resVec);
+QDataStream &operator>>(QDataStream &stream, QVector<QtApk::RepositoryUpdateResult> &resVec);
+
+#endif
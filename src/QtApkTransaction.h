@@ -4,6 +4,7 @@
 #define H_QTAPK_TRANSACTION
 
 #include <QObject>
+#include "QtApkDownloadProgress.h"
 #include "qtapk_exports.h"
 
 namespace QtApk {
@@ -25,6 +26,26 @@ class TransactionPrivate;
  * also want to connect to its signals before that, to prevent
  * race conditions (like transaction finished before you make
  * all the connections).
+ *
+ * Started transactions are queued and executed one after another,
+ * in order of start() calls. Consecutive queued add()-s (or del()-s,
+ * or updatePackageIndex()-es) with the same flags are executed as
+ * one operation; every transaction of such group gets the same
+ * result, and the changeset of the whole group. If merged add or
+ * del fails, its transactions are executed again one by one, so
+ * that a bad package spec fails only its own transaction; each of
+ * them then has its own changeset. Simulated add/del and upgrades
+ * are never merged.
+ *
+ * cancel() removes a queued transaction from the queue; a running
+ * one stops at the next safe point. Repository index fetches and
+ * package prefetch run in worker processes and are stopped right
+ * away, even in the middle of a transfer; a commit stops right
+ * before changes are applied. Once commit has started, it is
+ * finished. Cancelled transaction emits
+ * cancelled() and then finished(), errorOccured() is not emitted.
+ * Cancelling one of several merged transactions only detaches it,
+ * the operation keeps running for the others.
  */
 class QTAPK_EXPORTS Transaction : public QObject
 {
@@ -60,8 +81,16 @@ public Q_SLOTS:
 Q_SIGNALS:
     void descChanged();
     void finished();
+    //! progress of current step, in percent; emitted at most every 50 ms,
+    //!    only the latest value is reported
     void progressChanged(float percent);
+    //! byte-level progress of each download done by this transaction;
+    //!    emitted at most every 50 ms, with the latest value of every
+    //!    download that made progress since then
+    void downloadProgress(const QtApk::DownloadProgress &progress);
     void errorOccured(QString msg);
+    //! transaction was cancelled before it completed, finished() follows
+    void cancelled();
 
 private:
     TransactionPrivate *d_ptr = nullptr;
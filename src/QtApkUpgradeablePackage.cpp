@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "QtApkUpgradeablePackage.h"
+#include <QDataStream>
+
+
+namespace QtApk {
+
+
+UpgradeablePackage::UpgradeablePackage()
+{
+}
+
+UpgradeablePackage::UpgradeablePackage(const QString &pkgName, const QString &oldVer, const QString &newVer)
+{
+    name = pkgName;
+    oldVersion = oldVer;
+    newVersion = newVer;
+}
+
+UpgradeablePackage::~UpgradeablePackage()
+{
+}
+
+
+} // namespace QtApk
+
+
+QDataStream &operator<<(QDataStream &stream, const QtApk::UpgradeablePackage &upkg)
+{
+    stream << upkg.name;
+    stream << upkg.oldVersion;
+    stream << upkg.newVersion;
+    return stream;
+}
+
+QDataStream &operator>>(QDataStream &stream, QtApk::UpgradeablePackage &upkg)
+{
+    stream >> upkg.name;
+    stream >> upkg.oldVersion;
+    stream >> upkg.newVersion;
+    return stream;
+}
+
+QDataStream &operator<<(QDataStream &stream, const QVector<QtApk::UpgradeablePackage> &upkgVec)
+{
+    stream << upkgVec.size();
+    for (const QtApk::UpgradeablePackage &upkg : upkgVec) {
+        stream << upkg;
+    }
+    return stream;
+}
+
+QDataStream &operator>>(QDataStream &stream, QVector<QtApk::UpgradeablePackage> &upkgVec)
+{
+    int sz = 0;
+    stream >> sz;
+    upkgVec.reserve(sz);
+    for (int i = 0; i < sz; i++) {
+        QtApk::UpgradeablePackage upkg;
+        stream >> upkg;
+        upkgVec.append(std::move(upkg));
+    }
+    return stream;
+}
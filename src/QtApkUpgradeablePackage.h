@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef H_QTAPK_UPGRADEABLE_PACKAGE
+#define H_QTAPK_UPGRADEABLE_PACKAGE
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include "qtapk_exports.h"
+
+class QDataStream;
+
+namespace QtApk {
+
+/**
+ * @class UpgradeablePackage
+ * @brief Installed package for which a newer version is available
+ *
+ * Compact result of Database::getUpgradeablePackages():
+ * only package name and both versions.
+ */
+class QTAPK_EXPORTS UpgradeablePackage {
+    Q_GADGET
+    Q_PROPERTY(QString name MEMBER name)
+    Q_PROPERTY(QString oldVersion MEMBER oldVersion)
+    Q_PROPERTY(QString newVersion MEMBER newVersion)
+
+public:
+    UpgradeablePackage();
+    UpgradeablePackage(const QString &pkgName, const QString &oldVer, const QString &newVer);
+    UpgradeablePackage(const UpgradeablePackage &other) = default;
+    UpgradeablePackage(UpgradeablePackage &&other) = default;
+    virtual ~UpgradeablePackage();
+
+    UpgradeablePackage &operator=(const UpgradeablePackage &other) = default;
+    UpgradeablePackage &operator=(UpgradeablePackage &&other) = default;
+
+    QString name;
+    QString oldVersion;  //! currently installed version
+    QString newVersion;  //! best version available in repositories
+};
+
+}
+
+Q_DECLARE_METATYPE(QtApk::UpgradeablePackage)
+
+QDataStream &operator<<(QDataStream &stream, const QtApk::UpgradeablePackage &upkg);
+QDataStream &operator>>(QDataStream &stream, QtApk::UpgradeablePackage &upkg);
+QDataStream &operator<<(QDataStream &stream, const QVector<QtApk::UpgradeablePackage> &upkgVec);
+QDataStream &operator>>(QDataStream &stream, QVector<QtApk::UpgradeablePackage> &upkgVec);
+
+#endif
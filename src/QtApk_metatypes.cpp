@@ -1,9 +1,14 @@
 #include <QtGlobal>
 #include <QMetaType>
 
+#include "QtApkDependencyGraph.h"
+#include "QtApkDownloadProgress.h"
 #include "QtApkFlags.h"
 #include "QtApkPackage.h"
+#include "QtApkPackageView.h"
 #include "QtApkRepository.h"
+#include "QtApkRepositoryUpdateResult.h"
+#include "QtApkUpgradeablePackage.h"
 
 namespace QtApk {
 
@@ -15,9 +20,18 @@ static void registerMetaTypes()
     qRegisterMetaType<QtApk::Package>("QtApk::Package");
     qRegisterMetaTypeStreamOperators<QtApk::Package>("QtApk::Package");
     qRegisterMetaTypeStreamOperators<QVector<QtApk::Package>>("QVector<QtApk::Package>");
+    qRegisterMetaType<QtApk::PackageView>("QtApk::PackageView");
     qRegisterMetaType<QtApk::Repository>("QtApk::Repository");
     qRegisterMetaTypeStreamOperators<QtApk::Repository>("QtApk::Repository");
     qRegisterMetaTypeStreamOperators<QVector<QtApk::Repository>>("QVector<QtApk::Repository>");
+    qRegisterMetaType<QtApk::RepositoryUpdateResult>("QtApk::RepositoryUpdateResult");
+    qRegisterMetaTypeStreamOperators<QtApk::RepositoryUpdateResult>("QtApk::RepositoryUpdateResult");
+    qRegisterMetaTypeStreamOperators<QVector<QtApk::RepositoryUpdateResult>>("QVector<QtApk::RepositoryUpdateResult>");
+    qRegisterMetaType<QtApk::UpgradeablePackage>("QtApk::UpgradeablePackage");
+    qRegisterMetaTypeStreamOperators<QtApk::UpgradeablePackage>("QtApk::UpgradeablePackage");
+    qRegisterMetaTypeStreamOperators<QVector<QtApk::UpgradeablePackage>>("QVector<QtApk::UpgradeablePackage>");
+    qRegisterMetaType<QtApk::DependencyGraph>("QtApk::DependencyGraph");
+    qRegisterMetaType<QtApk::DownloadProgress>("QtApk::DownloadProgress");
     // also register flags
     qRegisterMetaType<QtApk::DbOpenFlags>("QtApk::DbOpenFlags");
     qRegisterMetaType<QtApk::DbOpenFlags>("DbOpenFlags"); // without namespace
@@ -25,8 +39,14 @@ static void registerMetaTypes()
     qRegisterMetaType<QtApk::DbUpdateFlags>("DbUpdateFlags"); // without namespace
     qRegisterMetaType<QtApk::DbUpgradeFlags>("QtApk::DbUpgradeFlags");
     qRegisterMetaType<QtApk::DbUpgradeFlags>("DbUpgradeFlags"); // without namespace
+    qRegisterMetaType<QtApk::DbAddFlags>("QtApk::DbAddFlags");
+    qRegisterMetaType<QtApk::DbAddFlags>("DbAddFlags"); // without namespace
     qRegisterMetaType<QtApk::DbDelFlags>("QtApk::DbDelFlags");
     qRegisterMetaType<QtApk::DbDelFlags>("DbDelFlags"); // without namespace
+    qRegisterMetaType<QtApk::DbQueryFlags>("QtApk::DbQueryFlags");
+    qRegisterMetaType<QtApk::DbQueryFlags>("DbQueryFlags"); // without namespace
+    qRegisterMetaType<QtApk::PackageFields>("QtApk::PackageFields");
+    qRegisterMetaType<QtApk::PackageFields>("PackageFields"); // without namespace
 }
 
 Q_CONSTRUCTOR_FUNCTION(registerMetaTypes);
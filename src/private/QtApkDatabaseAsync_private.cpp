@@ -4,22 +4,60 @@
 #include <stdio.h>
 #include <unistd.h>
 
+#include <QFutureInterface>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QObject>
 #include <QLoggingCategory>
+#include <QPointer>
+#include <QReadLocker>
+#include <QRunnable>
+#include <QWriteLocker>
 
 #include "QtApkDatabaseAsync_private.h"
 #include "../QtApkTransaction.h"
 #include "QtApkTransaction_private.h"
 
+#include <functional>
+#include <utility>
+
 Q_DECLARE_LOGGING_CATEGORY(LOG_QTAPK)
 
 namespace QtApk {
 
+// max rate of Transaction::progressChanged() signals
+static const int PROGRESS_SIGNAL_INTERVAL_MS = 50;
+// progress fd is read in chunks of this size
+static const int PROGRESS_PIPE_READ_SIZE = 4096;
+// package fields kept in snapshot: enough for package lists,
+//    and cheap to convert before every write transaction
+static const PackageFields SNAPSHOT_FIELDS = QTAPK_FIELD_NAME | QTAPK_FIELD_VERSION
+        | QTAPK_FIELD_ARCH | QTAPK_FIELD_DESCRIPTION | QTAPK_FIELD_SIZES;
+
 
 /**
  * @brief The BgThreadExecutor class
  * Small worker class whose slots will be executed
  * in the background thread.
+ *
+ * Started transactions are put into a FIFO queue and executed
+ * one by one. Where it is safe, consecutive queued transactions
+ * are coalesced into one libapk operation:
+ *  - add + add + ... with the same flags: one solve and commit
+ *    for all package specs together;
+ *  - del + del + ... with the same flags: the same;
+ *  - update + update + ... with the same flags: one update.
+ * Simulated add/del and upgrades are never merged. All transactions
+ * of a merged group receive the same result and changeset. If merged
+ * add or del fails, its operations are executed again one by one,
+ * so that a bad package spec fails only its own transaction, and
+ * each of them then gets its own changeset.
+ *
+ * Queued transaction is cancelled by removing it from the queue.
+ * Running transaction that shares its operation with others is only
+ * detached from the group and reported as cancelled; the operation is
+ * asked to stop via DatabasePrivate's cancel flag only when its last
+ * transaction is cancelled, so it never stops on behalf of others.
  */
 class BgThreadExecutor: public QObject
 {
@@ -28,111 +66,425 @@ public:
     BgThreadExecutor(): QObject(nullptr) { }
     ~BgThreadExecutor() override { }
 
-    void connectCurrentTransaction()
+    /**
+     * Queued transaction, with everything needed to execute it
+     */
+    struct Operation {
+        Transaction *transaction = nullptr;
+        Transaction::TransactionType type = Transaction::TransactionType::UPDATE;
+        QStringList pkgNameSpecs;        //! for ADD and DEL
+        int flags = 0;                   //! DbUpdateFlags, DbUpgradeFlags, DbAddFlags or DbDelFlags
+        Changeset *changeset = nullptr;  //! result goes there, owned by transaction
+    };
+
+    /**
+     * Result of an executed operation, delivered to its transaction
+     */
+    struct Result {
+        bool ok = false;
+        bool cancelled = false;
+        Changeset changes;
+        QString errorMsg;
+    };
+
+    /**
+     * @brief forgetTransaction
+     * Removes destroyed transaction from queue, and makes sure
+     * no results are delivered to it. Can be called from any thread.
+     */
+    void forgetTransaction(Transaction *trans)
     {
-        if (!currentTransaction) {
-            return;
+        QMutexLocker locker(&queueMutex);
+        for (int i = queue.size() - 1; i >= 0; i--) {
+            if (queue.at(i).transaction == trans) {
+                queue.removeAt(i);
+            }
         }
-        // now also create the connections between bg thread and current Transaction
-        // we cannot do it before, otherwise multiple connections can be triggered
-        // during our emit, if there are multiple transactions created
-        // because all of them would be connected to our single slot
-        QObject::connect(this, &BgThreadExecutor::operationFinished,
-                         currentTransaction, &Transaction::finished, Qt::QueuedConnection);
-        QObject::connect(this, &BgThreadExecutor::operationErrorOccured,
-                         currentTransaction, &Transaction::errorOccured, Qt::QueuedConnection);
+        running.removeAll(trans);
     }
 
-    void disconnectCurrentTransaction()
+    /**
+     * @brief cancelQueued
+     * Empties the queue, every transaction that was waiting in it
+     * is reported as cancelled. Can be called from any thread.
+     */
+    void cancelQueued()
     {
-        if (!currentTransaction) {
-            return;
+        QMutexLocker locker(&queueMutex);
+        for (const Operation &op : queue) {
+            postCancelled(op.transaction);
+        }
+        queue.clear();
+    }
+
+    /**
+     * @brief isIdle
+     * @return true if nothing is queued or running
+     */
+    bool isIdle()
+    {
+        QMutexLocker locker(&queueMutex);
+        return queue.isEmpty() && running.isEmpty();
+    }
+
+    /**
+     * @brief runningTransactions
+     * Must be called from the thread transactions live in.
+     * @return transactions that are being executed now
+     */
+    QVector<QPointer<Transaction>> runningTransactions()
+    {
+        QVector<QPointer<Transaction>> ret;
+        QMutexLocker locker(&queueMutex);
+        ret.reserve(running.size());
+        for (Transaction *trans : running) {
+            ret.append(QPointer<Transaction>(trans));
         }
-        QObject::disconnect(this, &BgThreadExecutor::operationFinished,
-                            currentTransaction, &Transaction::finished);
-        QObject::disconnect(this, &BgThreadExecutor::operationErrorOccured,
-                            currentTransaction, &Transaction::errorOccured);
+        return ret;
     }
 
 public Q_SLOTS:
 
-    // this function runs in the background thread
-    void startUpdatePackageIndex(void *ct, DbUpdateFlags flags)
+    // these functions are called directly from Transaction::start(),
+    //     in the caller's thread; they only put transaction into queue
+
+    void enqueueUpdatePackageIndex(void *ct, DbUpdateFlags flags)
     {
-        currentTransaction = reinterpret_cast<Transaction *>(ct);
-        isBusy = true;
-        bool ok = dbpriv->update(flags);
-        isBusy = false;
-        connectCurrentTransaction();
-        if (!ok) {
-            Q_EMIT operationErrorOccured(tr("Update package index failed"));
+        Operation op;
+        op.transaction = reinterpret_cast<Transaction *>(ct);
+        op.type = Transaction::TransactionType::UPDATE;
+        op.flags = flags;
+        enqueue(op);
+    }
+
+    void enqueueUpgradeSystem(void *ct, DbUpgradeFlags flags, void *pvChangeset)
+    {
+        Operation op;
+        op.transaction = reinterpret_cast<Transaction *>(ct);
+        op.type = Transaction::TransactionType::UPGRADE;
+        op.flags = flags;
+        op.changeset = reinterpret_cast<Changeset *>(pvChangeset);
+        enqueue(op);
+    }
+
+    void enqueueAddPackage(void *ct, const QStringList &packageNameSpecs, DbAddFlags flags, void *pvChangeset)
+    {
+        Operation op;
+        op.transaction = reinterpret_cast<Transaction *>(ct);
+        op.type = Transaction::TransactionType::ADD;
+        op.pkgNameSpecs = packageNameSpecs;
+        op.flags = flags;
+        op.changeset = reinterpret_cast<Changeset *>(pvChangeset);
+        enqueue(op);
+    }
+
+    void enqueueDelPackage(void *ct, const QStringList &packageNameSpecs, DbDelFlags flags, void *pvChangeset)
+    {
+        Operation op;
+        op.transaction = reinterpret_cast<Transaction *>(ct);
+        op.type = Transaction::TransactionType::DEL;
+        op.pkgNameSpecs = packageNameSpecs;
+        op.flags = flags;
+        op.changeset = reinterpret_cast<Changeset *>(pvChangeset);
+        enqueue(op);
+    }
+
+    // called directly from Transaction::cancel(), in the caller's thread
+    void cancelTransaction(void *ct)
+    {
+        Transaction *trans = reinterpret_cast<Transaction *>(ct);
+        QMutexLocker locker(&queueMutex);
+        for (int i = 0; i < queue.size(); i++) {
+            if (queue.at(i).transaction == trans) {
+                queue.removeAt(i);
+                postCancelled(trans);
+                return;
+            }
+        }
+        if (!running.contains(trans)) {
+            return;
         }
-        Q_EMIT operationFinished();
-        disconnectCurrentTransaction();
+        if (running.size() > 1) {
+            // others still wait for this operation's result
+            running.removeAll(trans);
+            postCancelled(trans);
+            return;
+        }
+        // stops at next safe point; flag is only reset
+        //    when next group is taken from the queue
+        dbpriv->request_cancel();
     }
 
     // this function runs in the background thread
-    void startUpgradeSystem(void *ct, DbUpgradeFlags flags, void *pvChangeset)
+    void processQueue()
     {
-        currentTransaction = reinterpret_cast<Transaction *>(ct);
-        Changeset *changeset = reinterpret_cast<Changeset *>(pvChangeset);
-        isBusy = true;
-        bool ok = dbpriv->upgrade(flags, changeset);
-        isBusy = false;
-        connectCurrentTransaction();
-        if (!ok) {
-            Q_EMIT operationErrorOccured(tr("System upgrade failed"));
+        QVector<Operation> group;
+        {
+            QMutexLocker locker(&queueMutex);
+            if (queue.isEmpty()) {
+                return; // already executed as a part of merged group
+            }
+            group.append(queue.takeFirst());
+            while (!queue.isEmpty() && canMerge(group.first(), queue.first())) {
+                group.append(queue.takeFirst());
+            }
+            for (const Operation &op : group) {
+                running.append(op.transaction);
+            }
+            // cancel requests for the previous group do not apply to this one
+            dbpriv->reset_cancel();
+        }
+
+        if (group.size() > 1) {
+            qCDebug(LOG_QTAPK) << "Coalesced" << group.size() << "queued transactions into one";
+        }
+
+        // readers get the state from before the transaction,
+        //    until it is finished and write lock is released
+        dbAsync->refreshSnapshot();
+        QVector<Result> results;
+        {
+            QWriteLocker writeLocker(dbAsync->databaseLock());
+            Result merged;
+            merged.ok = execute(mergeGroup(group), &merged.changes, &merged.errorMsg);
+            merged.cancelled = !merged.ok && dbpriv->is_cancel_requested();
+            results.fill(merged, group.size());
+            if (!merged.ok && !merged.cancelled && group.size() > 1
+                    && group.first().type != Transaction::TransactionType::UPDATE) {
+                // find out whose spec is bad; repeating add of already
+                //    added (or del of deleted) packages changes nothing
+                qCDebug(LOG_QTAPK) << "Coalesced transactions failed, executing them one by one";
+                for (int i = 0; i < group.size(); i++) {
+                    if (!isRunning(group.at(i).transaction)) {
+                        continue; // destroyed or cancelled meanwhile
+                    }
+                    Result &res = results[i];
+                    res.changes = Changeset();
+                    res.ok = execute(group.at(i), &res.changes, &res.errorMsg);
+                    // operation that completed despite the request is not cancelled
+                    res.cancelled = !res.ok && dbpriv->is_cancel_requested();
+                }
+            }
+        }
+        // last record may have been kept aside if ring was full
+        dbAsync->progressChannel.flush();
+        // progress timer may not get to the last download progress
+        //    before transactions finish, deliver it with the results
+        const QVector<DownloadProgress> downloads = dbAsync->takePendingDownloads();
+
+        // deliver results in transaction's thread; queued calls are
+        //    dropped by Qt if transaction is deleted before that
+        QMutexLocker locker(&queueMutex);
+        for (int i = 0; i < group.size(); i++) {
+            const Operation &op = group.at(i);
+            if (!running.contains(op.transaction)) {
+                continue; // destroyed or cancelled meanwhile
+            }
+            running.removeAll(op.transaction);
+            Transaction *trans = op.transaction;
+            Changeset *dst = op.changeset;
+            const Result res = results.at(i);
+            QMetaObject::invokeMethod(trans, [trans, dst, res, downloads]() {
+                for (const DownloadProgress &progress : downloads) {
+                    Q_EMIT trans->downloadProgress(progress);
+                }
+                if (dst) {
+                    *dst = res.changes;
+                }
+                if (res.cancelled) {
+                    Q_EMIT trans->cancelled();
+                } else if (!res.ok) {
+                    Q_EMIT trans->errorOccured(res.errorMsg);
+                }
+                Q_EMIT trans->finished();
+            }, Qt::QueuedConnection);
         }
-        Q_EMIT operationFinished();
-        disconnectCurrentTransaction();
     }
 
-    // this function runs in the background thread
-    void startAddPackage(void *ct, const QString &packageNameSpec)
+private:
+    // not emitted from inside cancel(), caller may delete transaction
+    static void postCancelled(Transaction *trans)
+    {
+        QMetaObject::invokeMethod(trans, [trans]() {
+            Q_EMIT trans->cancelled();
+            Q_EMIT trans->finished();
+        }, Qt::QueuedConnection);
+    }
+
+    void enqueue(const Operation &op)
     {
-        currentTransaction = reinterpret_cast<Transaction *>(ct);
-        isBusy = true;
-        bool ok = dbpriv->add(packageNameSpec);
-        isBusy = false;
-        connectCurrentTransaction();
-        if (!ok) {
-            Q_EMIT operationErrorOccured(tr("Add package failed"));
+        {
+            QMutexLocker locker(&queueMutex);
+            queue.append(op);
         }
-        Q_EMIT operationFinished();
-        disconnectCurrentTransaction();
+        DatabaseAsyncPrivate *dba = dbAsync;
+        QMetaObject::invokeMethod(dba, [dba]() {
+            dba->watchProgress();
+        }, Qt::AutoConnection);
+        QMetaObject::invokeMethod(this, "processQueue", Qt::QueuedConnection);
+    }
+
+    /**
+     * @brief canMerge
+     * @return true if next queued operation can be executed
+     *         together with the first one
+     */
+    static bool canMerge(const Operation &first, const Operation &next)
+    {
+        if (first.type != next.type || first.flags != next.flags) {
+            return false;
+        }
+        switch (first.type) {
+        case Transaction::TransactionType::UPDATE:
+            return true;
+        case Transaction::TransactionType::ADD:
+            return (first.flags & QTAPK_ADD_SIMULATE) == 0;
+        case Transaction::TransactionType::DEL:
+            return (first.flags & QTAPK_DEL_SIMULATE) == 0;
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * @brief mergeGroup
+     * @return one operation with package specs of the whole group
+     */
+    static Operation mergeGroup(const QVector<Operation> &group)
+    {
+        Operation merged = group.first();
+        for (int i = 1; i < group.size(); i++) {
+            for (const QString &spec : group.at(i).pkgNameSpecs) {
+                if (!merged.pkgNameSpecs.contains(spec)) {
+                    merged.pkgNameSpecs.append(spec);
+                }
+            }
+        }
+        return merged;
+    }
+
+    bool isRunning(Transaction *trans)
+    {
+        QMutexLocker locker(&queueMutex);
+        return running.contains(trans);
     }
 
     // this function runs in the background thread
-    void startDelPackage(void *ct, const QString &packageNameSpec, DbDelFlags flags)
+    bool execute(const Operation &op, Changeset *changes, QString *errorMsg)
     {
-        currentTransaction = reinterpret_cast<Transaction *>(ct);
-        isBusy = true;
-        bool ok = dbpriv->del(packageNameSpec, flags);
-        isBusy = false;
-        connectCurrentTransaction();
-        if (!ok) {
-            Q_EMIT operationErrorOccured(tr("Remove package failed"));
+        bool ok = false;
+        switch (op.type) {
+        case Transaction::TransactionType::UPDATE:
+            ok = dbpriv->update(static_cast<DbUpdateFlags>(op.flags));
+            *errorMsg = tr("Update package index failed");
+            break;
+        case Transaction::TransactionType::UPGRADE:
+            ok = dbpriv->upgrade(static_cast<DbUpgradeFlags>(op.flags), changes);
+            *errorMsg = tr("System upgrade failed");
+            break;
+        case Transaction::TransactionType::ADD:
+            ok = dbpriv->add(op.pkgNameSpecs, static_cast<DbAddFlags>(op.flags), changes);
+            *errorMsg = tr("Add package failed");
+            break;
+        case Transaction::TransactionType::DEL:
+            ok = dbpriv->del(op.pkgNameSpecs, static_cast<DbDelFlags>(op.flags), changes);
+            *errorMsg = tr("Remove package failed");
+            break;
         }
-        Q_EMIT operationFinished();
-        disconnectCurrentTransaction();
+        return ok;
     }
 
-Q_SIGNALS:
-    void operationErrorOccured(QString msg);
-    void operationFinished();
 public:
     DatabasePrivate *dbpriv = nullptr;
-    Transaction *currentTransaction = nullptr;
-    bool isBusy = false;
+    DatabaseAsyncPrivate *dbAsync = nullptr;
+
+private:
+    QMutex queueMutex;             //! protects queue and running
+    QList<Operation> queue;        //! transactions waiting for execution
+    QVector<Transaction *> running; //! transactions being executed now
 };
 
 
+/**
+ * @brief The TryReadLocker class
+ * Tries to lock database for reading, without waiting for
+ * a running write transaction; unlocks only if it succeeded.
+ */
+class TryReadLocker
+{
+public:
+    explicit TryReadLocker(QReadWriteLock *lock)
+        : m_lock(lock), m_locked(lock->tryLockForRead())
+    {
+    }
+
+    ~TryReadLocker()
+    {
+        if (m_locked) {
+            m_lock->unlock();
+        }
+    }
+
+    bool isLocked() const { return m_locked; }
+
+private:
+    QReadWriteLock *m_lock;
+    bool m_locked;
+    Q_DISABLE_COPY(TryReadLocker)
+};
+
+
+/**
+ * @brief The QueryTask class
+ * Runs a query function in a thread pool and reports its
+ * result to QFuture. Results are implicitly shared Qt containers,
+ * so handing them over to the caller's thread does not copy data.
+ */
+template <typename T>
+class QueryTask: public QRunnable
+{
+public:
+    explicit QueryTask(std::function<T()> query)
+        : m_query(std::move(query))
+    {
+        m_fi.reportStarted();
+    }
+
+    QFuture<T> future() { return m_fi.future(); }
+
+    void run() override
+    {
+        if (!m_fi.isCanceled()) {
+            const T result = m_query();
+            m_fi.reportResult(result);
+        }
+        m_fi.reportFinished();
+    }
+
+private:
+    QFutureInterface<T> m_fi;
+    std::function<T()> m_query;
+};
+
+template <typename T>
+static QFuture<T> startQuery(QThreadPool *pool, std::function<T()> query)
+{
+    QueryTask<T> *task = new QueryTask<T>(std::move(query));
+    const QFuture<T> ret = task->future();
+    pool->start(task); // pool deletes task when it is done
+    return ret;
+}
+
+
 DatabaseAsyncPrivate::DatabaseAsyncPrivate(DatabaseAsync *q)
     : q_ptr(q)
 {
     // DatabasePrivate actually doesn't even use its q_ptr
     // FIXME: something to fix in DatabasePrivate?
     dbpriv = new DatabasePrivate(nullptr);
+    progressTimer.setInterval(PROGRESS_SIGNAL_INTERVAL_MS);
+    QObject::connect(&progressTimer, &QTimer::timeout,
+                     this, &DatabaseAsyncPrivate::onProgressTimer);
 }
 
 DatabaseAsyncPrivate::~DatabaseAsyncPrivate()
@@ -164,12 +516,30 @@ bool DatabaseAsyncPrivate::open(DbOpenFlags flags)
         // and start bg thread only if database was opened
         executor = new BgThreadExecutor();
         executor->dbpriv = this->dbpriv;
+        executor->dbAsync = this;
         executor->moveToThread(&bgThread);
-        //
-        socketNotifier = new QSocketNotifier(dbpriv->progressFd(), QSocketNotifier::Read);
-        QObject::connect(socketNotifier, &QSocketNotifier::activated,
-                         this, &DatabaseAsyncPrivate::onSocketNotifierActivated);
-        socketNotifier->setEnabled(false);
+        // drop anything left from previous open
+        drainProgressChannel();
+        latestProgressEmitted = true;
+        dbpriv->set_progress_channel(&progressChannel);
+        // libapk reports commit progress only as text to progress fd
+        if (dbpriv->progressFd() > 0) {
+            socketNotifier = new QSocketNotifier(dbpriv->progressFd(), QSocketNotifier::Read);
+            QObject::connect(socketNotifier, &QSocketNotifier::activated,
+                             this, &DatabaseAsyncPrivate::onSocketNotifierActivated);
+            socketNotifier->setEnabled(false);
+        }
+        // downloads report progress from bg thread, as often as libapk
+        //   reads data; keep only the latest one, progressTimer
+        //   forwards it to current transactions in our thread
+        {
+            QMutexLocker locker(&pendingDownloadsMutex);
+            pendingDownloads.clear();
+        }
+        dbpriv->set_download_progress_callback([this](const DownloadProgress &progress) {
+            QMutexLocker locker(&pendingDownloadsMutex);
+            pendingDownloads.insert(progress.url, progress);
+        });
         //
         bgThread.start();
     }
@@ -178,18 +548,33 @@ bool DatabaseAsyncPrivate::open(DbOpenFlags flags)
 
 void DatabaseAsyncPrivate::close()
 {
+    // queries in pool use database, let them finish
+    queryPool.waitForDone();
+    dbpriv->set_download_progress_callback(DownloadProgressCallback());
+    progressTimer.stop();
+    progressPipeBuffer.clear();
     if (socketNotifier) {
         socketNotifier->setEnabled(false);
         delete socketNotifier;
         socketNotifier = nullptr;
     }
     if (bgThread.isRunning()) {
+        // queued transactions will never run, tell them so
+        executor->cancelQueued();
+        // do not let running operation hold us longer than needed
+        dbpriv->request_cancel();
         bgThread.requestInterruption();
         bgThread.exit(0);
+        // executor may still be in processQueue(), running operation
+        //    returns at its next cancel check
+        bgThread.wait();
         delete executor;
         executor = nullptr;
     }
-    dbpriv->close(); // this also closes progress_fd pipe
+    dbpriv->close(); // progress_fd pipe stays open until dbpriv is deleted
+    dbpriv->set_progress_channel(nullptr);
+    QMutexLocker locker(&snapshotMutex);
+    snapshot.clear();
 }
 
 bool DatabaseAsyncPrivate::isOpen() const
@@ -202,26 +587,63 @@ Transaction *DatabaseAsyncPrivate::updatePackageIndex(DbUpdateFlags flags)
     if (!checkCanStart()) {
         return nullptr;
     }
-    // now that we have to do something, we can enable progress watched
-    if (socketNotifier) {
-        socketNotifier->setEnabled(true);
-    }
-
     TransactionUpdatePrivate *trp = new TransactionUpdatePrivate(
-                executor, "startUpdatePackageIndex", flags);
+                executor, "enqueueUpdatePackageIndex", flags);
     return createReturnTransaction(trp);
 }
 
+void DatabaseAsyncPrivate::setIndexMaxAge(int seconds)
+{
+    dbpriv->set_index_max_age(seconds);
+}
+
+int DatabaseAsyncPrivate::indexMaxAge() const
+{
+    return dbpriv->index_max_age();
+}
+
+QMap<QString, QDateTime> DatabaseAsyncPrivate::repositoryRefreshTimes() const
+{
+    return dbpriv->repository_refresh_times();
+}
+
 int DatabaseAsyncPrivate::upgradeablePackagesCount()
 {
-    int totalUpgrades = 0;
-    Changeset changes;
+    QMutexLocker queryLocker(&queryMutex);
+    // runs solver, so cannot be answered from snapshot
+    TryReadLocker locker(&dbLock);
+    if (locker.isLocked()) {
+        lastUpgradeableCount = dbpriv->upgradeable_packages_count();
+    }
+    return lastUpgradeableCount;
+}
+
+QVector<UpgradeablePackage> DatabaseAsyncPrivate::getUpgradeablePackages() const
+{
+    TryReadLocker locker(&dbLock);
+    if (!locker.isLocked()) {
+        const QSharedPointer<const PackageSnapshot> snap = currentSnapshot();
+        return snap ? snap->upgradeable : QVector<UpgradeablePackage>();
+    }
+    return dbpriv->get_upgradeable_packages();
+}
+
+DependencyGraph DatabaseAsyncPrivate::getInstalledDependencyGraph() const
+{
+    TryReadLocker locker(&dbLock);
+    if (!locker.isLocked()) {
+        return DependencyGraph();
+    }
+    return dbpriv->get_installed_dependency_graph();
+}
 
-    if (dbpriv->upgrade(QTAPK_UPGRADE_SIMULATE, &changes)) {
-        // Don't count packages to remove
-        totalUpgrades = changes.numInstall() + changes.numAdjust();
+DependencyGraph DatabaseAsyncPrivate::getAvailableDependencyGraph() const
+{
+    TryReadLocker locker(&dbLock);
+    if (!locker.isLocked()) {
+        return DependencyGraph();
     }
-    return totalUpgrades;
+    return dbpriv->get_available_dependency_graph();
 }
 
 Transaction *DatabaseAsyncPrivate::upgrade(DbUpgradeFlags flags, Changeset *changes)
@@ -230,54 +652,190 @@ Transaction *DatabaseAsyncPrivate::upgrade(DbUpgradeFlags flags, Changeset *chan
     if (!checkCanStart()) {
         return nullptr;
     }
-    // now that we have to do something, we can enable progress watcher
-    if (socketNotifier) {
-        socketNotifier->setEnabled(true);
-    }
-
     TransactionUpgradePrivate *trp = new TransactionUpgradePrivate(
-                executor, "startUpgradeSystem", flags);
+                executor, "enqueueUpgradeSystem", flags);
     return createReturnTransaction(trp);
 }
 
 Transaction *DatabaseAsyncPrivate::add(const QString &packageNameSpec)
+{
+    return add(QStringList(packageNameSpec));
+}
+
+Transaction *DatabaseAsyncPrivate::del(const QString &packageNameSpec, DbDelFlags flags)
+{
+    return del(QStringList(packageNameSpec), flags);
+}
+
+Transaction *DatabaseAsyncPrivate::add(const QStringList &packageNameSpecs, DbAddFlags flags)
 {
     if (!checkCanStart()) {
         return nullptr;
     }
-    // now that we have to do something, we can enable progress watcher
-    if (socketNotifier) {
-        socketNotifier->setEnabled(true);
-    }
-
     TransactionAddPrivate *trp = new TransactionAddPrivate(
-                executor, "startAddPackage", packageNameSpec);
+                executor, "enqueueAddPackage", packageNameSpecs, flags);
     return createReturnTransaction(trp);
 }
 
-Transaction *DatabaseAsyncPrivate::del(const QString &packageNameSpec, DbDelFlags flags)
+Transaction *DatabaseAsyncPrivate::del(const QStringList &packageNameSpecs, DbDelFlags flags)
 {
     if (!checkCanStart()) {
         return nullptr;
     }
-    // now that we have to do something, we can enable progress watcher
-    if (socketNotifier) {
-        socketNotifier->setEnabled(true);
-    }
-
     TransactionDelPrivate *trp = new TransactionDelPrivate(
-                executor, "startDelPackage", packageNameSpec, flags);
+                executor, "enqueueDelPackage", packageNameSpecs, flags);
     return createReturnTransaction(trp);
 }
 
-QVector<Package> DatabaseAsyncPrivate::getInstalledPackages() const
+QVector<Package> DatabaseAsyncPrivate::getInstalledPackages(PackageFields fields) const
+{
+    TryReadLocker locker(&dbLock);
+    if (!locker.isLocked()) {
+        const QSharedPointer<const PackageSnapshot> snap = currentSnapshot();
+        return snap ? snap->installed : QVector<Package>();
+    }
+    return dbpriv->get_installed_packages(fields);
+}
+
+QVector<Package> DatabaseAsyncPrivate::getAvailablePackages(PackageFields fields, DbQueryFlags qflags) const
+{
+    TryReadLocker locker(&dbLock);
+    if (!locker.isLocked()) {
+        const QSharedPointer<const PackageSnapshot> snap = currentSnapshot();
+        return snap ? snap->available : QVector<Package>();
+    }
+    return dbpriv->get_available_packages(fields, qflags);
+}
+
+QVector<Package> DatabaseAsyncPrivate::findPackage(const QString &name, PackageFields fields) const
 {
-    return dbpriv->get_installed_packages();
+    TryReadLocker locker(&dbLock);
+    if (!locker.isLocked()) {
+        // snapshot has no names hash, only real package names are found
+        QVector<Package> ret;
+        const QSharedPointer<const PackageSnapshot> snap = currentSnapshot();
+        if (snap) {
+            for (const Package &pkg : snap->available) {
+                if (pkg.name == name) {
+                    ret.append(pkg);
+                }
+            }
+        }
+        return ret;
+    }
+    return dbpriv->find_package(name, fields);
 }
 
-QVector<Package> DatabaseAsyncPrivate::getAvailablePackages() const
+Package DatabaseAsyncPrivate::findInstalled(const QString &name, PackageFields fields) const
 {
-    return dbpriv->get_available_packages();
+    TryReadLocker locker(&dbLock);
+    if (!locker.isLocked()) {
+        const QSharedPointer<const PackageSnapshot> snap = currentSnapshot();
+        if (snap) {
+            for (const Package &pkg : snap->installed) {
+                if (pkg.name == name) {
+                    return pkg;
+                }
+            }
+        }
+        return Package();
+    }
+    return dbpriv->find_installed(name, fields);
+}
+
+QVector<Package> DatabaseAsyncPrivate::search(const QString &query, int limit, PackageFields fields) const
+{
+    QMutexLocker queryLocker(&queryMutex);
+    // search index points into live database, it cannot be used
+    //    with snapshot; packages are copied while read lock is held
+    TryReadLocker locker(&dbLock);
+    if (!locker.isLocked()) {
+        return QVector<Package>();
+    }
+    return dbpriv->search_packages(query, limit, fields);
+}
+
+QStringList DatabaseAsyncPrivate::completeName(const QString &prefix, int limit) const
+{
+    QMutexLocker queryLocker(&queryMutex);
+    TryReadLocker locker(&dbLock);
+    if (!locker.isLocked()) {
+        return QStringList();
+    }
+    return dbpriv->complete_name(prefix, limit);
+}
+
+QFuture<QVector<Package>> DatabaseAsyncPrivate::getInstalledPackagesAsync(PackageFields fields) const
+{
+    return startQuery<QVector<Package>>(&queryPool, [this, fields]() {
+        return getInstalledPackages(fields);
+    });
+}
+
+QFuture<QVector<Package>> DatabaseAsyncPrivate::getAvailablePackagesAsync(PackageFields fields,
+                                                                         DbQueryFlags qflags) const
+{
+    return startQuery<QVector<Package>>(&queryPool, [this, fields, qflags]() {
+        return getAvailablePackages(fields, qflags);
+    });
+}
+
+QFuture<int> DatabaseAsyncPrivate::upgradeablePackagesCountAsync()
+{
+    return startQuery<int>(&queryPool, [this]() {
+        return upgradeablePackagesCount();
+    });
+}
+
+QFuture<QVector<Package>> DatabaseAsyncPrivate::searchAsync(const QString &query, int limit,
+                                                           PackageFields fields) const
+{
+    return startQuery<QVector<Package>>(&queryPool, [this, query, limit, fields]() {
+        return search(query, limit, fields);
+    });
+}
+
+/**
+ * @brief DatabaseAsyncPrivate::refreshSnapshot
+ * Called from background thread before it starts changing
+ * database, without holding database lock. Snapshot is taken
+ * under read lock and query mutex, like other queries. Only
+ * SNAPSHOT_FIELDS are converted, so that a write transaction does
+ * not wait for a full copy of every package. It is taken
+ * again only if database changed since the last one; new snapshot
+ * replaces old one atomically, readers that still hold the old one
+ * keep it.
+ */
+void DatabaseAsyncPrivate::refreshSnapshot()
+{
+    const int gen = dbpriv->current_generation();
+    {
+        QMutexLocker locker(&snapshotMutex);
+        if (snapshot && snapshot->generation == gen) {
+            return;
+        }
+    }
+    QSharedPointer<PackageSnapshot> snap(new PackageSnapshot());
+    {
+        // queries run in other threads meanwhile, and some of them
+        //    (upgradeablePackagesCount() runs the solver) modify libapk
+        //    state under read lock; same lock order as in queries
+        QMutexLocker queryLocker(&queryMutex);
+        QReadLocker readLocker(&dbLock);
+        snap->generation = dbpriv->current_generation();
+        snap->installed = dbpriv->get_installed_packages(SNAPSHOT_FIELDS);
+        snap->available = dbpriv->get_available_packages(SNAPSHOT_FIELDS, QTAPK_QUERY_PARALLEL);
+        snap->upgradeable = dbpriv->get_upgradeable_packages();
+    }
+
+    QMutexLocker locker(&snapshotMutex);
+    snapshot = snap;
+}
+
+QSharedPointer<const PackageSnapshot> DatabaseAsyncPrivate::currentSnapshot() const
+{
+    QMutexLocker locker(&snapshotMutex);
+    return snapshot;
 }
 
 /**
@@ -290,12 +848,8 @@ bool DatabaseAsyncPrivate::checkCanStart()
         qCWarning(LOG_QTAPK) << Q_FUNC_INFO << "cannot start transaction: no BG Thread!";
         return false;
     }
-    if (executor->isBusy) {
-        qCWarning(LOG_QTAPK) << Q_FUNC_INFO << "cannot execute more then one Transaction in parallel!";
-        // Theoretically we could execute as many package operations
-        // in parallel as we want. But our package manager would not like it!
-        return false;
-    }
+    // transactions are queued and executed one by one, so
+    //    there is no need to check if another one is running
     return true;
 }
 
@@ -317,21 +871,106 @@ Transaction *DatabaseAsyncPrivate::createReturnTransaction(TransactionPrivate *t
     return tr;
 }
 
+/**
+ * @brief DatabaseAsyncPrivate::watchProgress
+ * Called when transaction is queued: progress is watched
+ * until queue becomes empty.
+ */
+void DatabaseAsyncPrivate::watchProgress()
+{
+    if (socketNotifier) {
+        socketNotifier->setEnabled(true);
+    }
+    if (!progressTimer.isActive()) {
+        progressTimer.start();
+    }
+}
+
+QVector<DownloadProgress> DatabaseAsyncPrivate::takePendingDownloads()
+{
+    QMutexLocker locker(&pendingDownloadsMutex);
+    QVector<DownloadProgress> ret;
+    ret.reserve(pendingDownloads.size());
+    for (const DownloadProgress &progress : pendingDownloads) {
+        ret.append(progress);
+    }
+    pendingDownloads.clear();
+    return ret;
+}
+
+void DatabaseAsyncPrivate::drainProgressChannel()
+{
+    ProgressRecord rec;
+    if (progressChannel.drain(&rec) > 0) {
+        latestProgress = rec;
+        latestProgressEmitted = false;
+    }
+}
+
 void DatabaseAsyncPrivate::onSocketNotifierActivated(int sock)
 {
-    char buf[64] = {0}; // 64 bytes should be enough for everyone
-    std::size_t nr = ::read(sock, buf, sizeof(buf)-1);
-    if (nr > 0) {
-        uint64_t p1, p2;
-        ::sscanf(buf, "%" PRIu64 "/%" PRIu64, &p1, &p2);
-        float fpercent = 0.0f;
-        if (p2) {
-            fpercent = 100.0f * static_cast<float>(p1) / static_cast<float>(p2);
+    char buf[PROGRESS_PIPE_READ_SIZE];
+    const ssize_t nr = ::read(sock, buf, sizeof(buf));
+    if (nr <= 0) {
+        return;
+    }
+    // our own records sent before libapk's commit started come first
+    drainProgressChannel();
+
+    // libapk writes "done/total\n" records, a read may end in the
+    //    middle of one; only the last complete record matters
+    progressPipeBuffer.append(buf, static_cast<int>(nr));
+    int lineStart = 0;
+    int lineEnd;
+    while ((lineEnd = progressPipeBuffer.indexOf('\n', lineStart)) >= 0) {
+        uint64_t p1 = 0, p2 = 0;
+        if (::sscanf(progressPipeBuffer.constData() + lineStart,
+                     "%" SCNu64 "/%" SCNu64, &p1, &p2) == 2) {
+            latestProgress.phase = PROGRESS_PHASE_COMMIT;
+            latestProgress.done = p1;
+            latestProgress.total = p2;
+            latestProgress.bytes = 0;
+            latestProgressEmitted = false;
+        }
+        lineStart = lineEnd + 1;
+    }
+    progressPipeBuffer.remove(0, lineStart);
+}
+
+void DatabaseAsyncPrivate::onProgressTimer()
+{
+    drainProgressChannel();
+    const QVector<DownloadProgress> downloads = takePendingDownloads();
+    if (executor && !downloads.isEmpty()) {
+        for (const QPointer<Transaction> &tr : executor->runningTransactions()) {
+            for (const DownloadProgress &progress : downloads) {
+                if (tr) {
+                    Q_EMIT tr->downloadProgress(progress);
+                }
+            }
         }
-        // now we need to invoke Transaction's progress() signal
-        // pray that currentTransaction pointer is still valid
-        if (executor && executor->currentTransaction) {
-            Q_EMIT executor->currentTransaction->progressChanged(fpercent);
+    }
+    if (latestProgressEmitted) {
+        // nothing new; stop polling when there is nothing to wait for
+        if (!executor || executor->isIdle()) {
+            progressTimer.stop();
+        }
+        return;
+    }
+    latestProgressEmitted = true;
+
+    float fpercent = 0.0f;
+    if (latestProgress.total) {
+        fpercent = 100.0f * static_cast<float>(latestProgress.done)
+                / static_cast<float>(latestProgress.total);
+    }
+    // now we need to invoke Transaction's progress() signal,
+    //    for all transactions that are being executed
+    if (executor) {
+        for (const QPointer<Transaction> &tr : executor->runningTransactions()) {
+            if (tr) {
+                Q_EMIT tr->progressChanged(fpercent);
+            }
         }
     }
 }
@@ -341,9 +980,7 @@ void DatabaseAsyncPrivate::onTransactionDestroyed(QObject *obj)
     if (!executor) {
         return;
     }
-    if (obj == executor->currentTransaction) {
-        executor->currentTransaction = nullptr;
-    }
+    executor->forgetTransaction(static_cast<Transaction *>(obj));
 }
 
 
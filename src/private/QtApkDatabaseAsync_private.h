@@ -3,18 +3,39 @@
 #ifndef H_QTAPK_DATABASE_ASYNC_PRIVATE
 #define H_QTAPK_DATABASE_ASYNC_PRIVATE
 
+#include <QFuture>
+#include <QMap>
+#include <QMutex>
 #include <QObject>
+#include <QReadWriteLock>
+#include <QSharedPointer>
 #include <QThread>
+#include <QThreadPool>
+#include <QTimer>
 #include <QSocketNotifier>
 
 #include "../QtApkDatabaseAsync.h"
 #include "QtApkDatabase_private.h"
+#include "QtApkProgressChannel.h"
 
 namespace QtApk {
 
 class BgThreadExecutor;
 class TransactionPrivate;
 
+/**
+ * @brief The PackageSnapshot struct
+ * Immutable copy of package metadata, used to answer queries
+ * while a write transaction is running in background thread.
+ * Packages have only SNAPSHOT_FIELDS filled in.
+ */
+struct PackageSnapshot {
+    int generation = -1;   //! database generation it was taken at
+    QVector<Package> installed;
+    QVector<Package> available;
+    QVector<UpgradeablePackage> upgradeable;
+};
+
 class DatabaseAsyncPrivate: public QObject
 {
     Q_OBJECT
@@ -28,17 +49,45 @@ public:
     void close();
     bool isOpen() const;
     Transaction *updatePackageIndex(DbUpdateFlags flags = QTAPK_UPDATE_DEFAULT);
+    void setIndexMaxAge(int seconds);
+    int indexMaxAge() const;
+    QMap<QString, QDateTime> repositoryRefreshTimes() const;
     int upgradeablePackagesCount();
+    QVector<UpgradeablePackage> getUpgradeablePackages() const;
+    DependencyGraph getInstalledDependencyGraph() const;
+    DependencyGraph getAvailableDependencyGraph() const;
     Transaction *upgrade(DbUpgradeFlags flags = QTAPK_UPGRADE_DEFAULT, Changeset *changes = nullptr);
     Transaction *add(const QString &packageNameSpec);
     Transaction *del(const QString &packageNameSpec, DbDelFlags flags = QTAPK_DEL_DEFAULT);
-    QVector<Package> getInstalledPackages() const;
-    QVector<Package> getAvailablePackages() const;
+    Transaction *add(const QStringList &packageNameSpecs, DbAddFlags flags = QTAPK_ADD_DEFAULT);
+    Transaction *del(const QStringList &packageNameSpecs, DbDelFlags flags = QTAPK_DEL_DEFAULT);
+    QVector<Package> getInstalledPackages(PackageFields fields = QTAPK_FIELD_ALL) const;
+    QVector<Package> getAvailablePackages(PackageFields fields = QTAPK_FIELD_ALL,
+                                          DbQueryFlags qflags = QTAPK_QUERY_DEFAULT) const;
+    QVector<Package> findPackage(const QString &name, PackageFields fields = QTAPK_FIELD_ALL) const;
+    Package findInstalled(const QString &name, PackageFields fields = QTAPK_FIELD_ALL) const;
+    QVector<Package> search(const QString &query, int limit, PackageFields fields) const;
+    QStringList completeName(const QString &prefix, int limit = 20) const;
+    QFuture<QVector<Package>> getInstalledPackagesAsync(PackageFields fields) const;
+    QFuture<QVector<Package>> getAvailablePackagesAsync(PackageFields fields, DbQueryFlags qflags) const;
+    QFuture<int> upgradeablePackagesCountAsync();
+    QFuture<QVector<Package>> searchAsync(const QString &query, int limit, PackageFields fields) const;
+
+    // used by background thread
+    void refreshSnapshot();
+    QReadWriteLock *databaseLock() { return &dbLock; }
+    // starts watching progress until executor is idle
+    void watchProgress();
+    // latest progress of downloads that was not emitted yet
+    QVector<DownloadProgress> takePendingDownloads();
 
 protected:
     bool checkCanStart();
+    QSharedPointer<const PackageSnapshot> currentSnapshot() const;
     Transaction *createReturnTransaction(TransactionPrivate *trp);
     void onSocketNotifierActivated(int sock);
+    void onProgressTimer();
+    void drainProgressChannel();
     void onTransactionDestroyed(QObject *obj);
 
 public:
@@ -48,6 +97,31 @@ public:
     DatabasePrivate *dbpriv = nullptr;
     QSocketNotifier *socketNotifier = nullptr;
     QThread bgThread;
+
+    // progress of our own steps comes through progressChannel, libapk's
+    //    commit progress through progress fd; both are merged into
+    //    latestProgress and emitted by progressTimer at a bounded rate
+    ProgressChannel progressChannel;
+    QTimer progressTimer;
+    QByteArray progressPipeBuffer;  //! incomplete record read from progress fd
+    ProgressRecord latestProgress;
+    bool latestProgressEmitted = true;
+    // download callback only stores the latest progress of each
+    //    download (by url), progressTimer emits them
+    QMutex pendingDownloadsMutex; //! protects pendingDownloads
+    QMap<QString, DownloadProgress> pendingDownloads;
+
+    // background thread holds write lock while it changes database,
+    //    queries that cannot get read lock are answered from snapshot
+    mutable QReadWriteLock dbLock;
+    mutable QMutex snapshotMutex; //! protects snapshot pointer
+    QSharedPointer<const PackageSnapshot> snapshot;
+    int lastUpgradeableCount = 0; //! last upgradeablePackagesCount() result
+
+    // queries can also run in queryPool threads; queries that fill
+    //    lazy caches or run solver are serialized by queryMutex
+    mutable QMutex queryMutex;
+    mutable QThreadPool queryPool;
 };
 
 
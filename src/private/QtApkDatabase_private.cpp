@@ -5,10 +5,18 @@
 #include <QDebug>
 #include <QLoggingCategory>
 #include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
 
+#include <cerrno>
 #include <unistd.h>
 
 #include "private/libapk_c_wrappers.h"
+#include "private/QtApkDependencyGraphBuilder.h"
+#include "private/QtApkPlan_private.h"
 
 #ifdef QT_DEBUG
 Q_LOGGING_CATEGORY(LOG_QTAPK, "qtapk", QtDebugMsg)
@@ -19,9 +27,257 @@ Q_LOGGING_CATEGORY(LOG_QTAPK, "qtapk", QtInfoMsg)
 namespace QtApk {
 
 // forwards for some internals
-static Package apk_package_to_QtApkPackage(struct apk_package *pkg);
 static int cb_append_package_to_vector(void *hash_item, void *ctx);
-static void cb_enum_installed(struct apk_package *pkg, void *pv);
+static int cb_enum_installed(struct apk_package *pkg, void *pv);
+static int cb_append_view_to_vector(void *hash_item, void *ctx);
+static int cb_enum_installed_view(struct apk_package *pkg, void *pv);
+static int cb_visit_available(void *hash_item, void *ctx);
+static int cb_visit_installed(struct apk_package *pkg, void *ctx);
+static int cb_append_package_ptr_to_vector(void *hash_item, void *ctx);
+static int cb_append_name_to_vector(void *hash_item, void *ctx);
+static int cb_append_upgradeable_to_vector(struct apk_package *old_pkg,
+                                           struct apk_package *new_pkg, void *ctx);
+static int cb_add_installed_to_graph(struct apk_package *pkg, void *ctx);
+static int cb_add_available_to_graph(void *hash_item, void *ctx);
+
+/**
+ * Internal struct passed as void* context to package
+ * conversion callbacks
+ */
+struct PackageConvertContext {
+    QVector<Package> *vec;  //! output vector
+    PackageFields fields;   //! which fields to convert
+};
+
+/**
+ * Internal struct passed as void* context to package
+ * visitor callbacks
+ */
+struct PackageVisitorContext {
+    const PackageVisitor *visitor; //! user's visitor function
+    int numVisited;                //! number of packages passed to visitor
+};
+
+// parallel conversion does not make sense for less
+// packages than that per one thread
+static const int PARALLEL_MIN_CHUNK_SIZE = 256;
+
+/**
+ * @brief The PackageConvertTask class
+ * Converts a contiguous chunk of package pointers into a
+ * pre-sized output array; used by get_available_packages_parallel().
+ * Each task writes to its own slice of output, so no locking
+ * is needed.
+ */
+class PackageConvertTask: public QRunnable
+{
+public:
+    PackageConvertTask(struct apk_package *const *in, Package *out, int count,
+                       PackageFields fields, QSemaphore *done)
+        : m_in(in), m_out(out), m_count(count), m_fields(fields), m_done(done)
+    {
+    }
+
+    void run() override
+    {
+        for (int i = 0; i < m_count; i++) {
+            m_out[i] = apk_package_to_QtApkPackage(m_in[i], m_fields);
+        }
+        m_done->release();
+    }
+
+private:
+    struct apk_package *const *m_in;
+    Package *m_out;
+    int m_count;
+    PackageFields m_fields;
+    QSemaphore *m_done;
+};
+
+/**
+ * @brief write_progress
+ * Reports progress to database's own progress pipe, the one libapk
+ * writes to during commit, in exactly the same format as libapk
+ * does: "done/total\n"
+ */
+static void write_progress(int fd, size_t done, size_t total)
+{
+    char progress_buf[64] = {0}; // enough for petabytes...
+
+    if (fd == 0) {
+        return;
+    }
+    const int buflen = ::snprintf(progress_buf, sizeof(progress_buf), "%zu/%zu\n", done, total);
+    ::write(fd, progress_buf, buflen);
+}
+
+// protects libapk's global apk_progress_fd, see ProgressFdLease
+static QMutex progressFdMutex;
+
+/**
+ * @brief The ProgressFdLease class
+ * libapk writes commit progress to process-global apk_progress_fd.
+ * Lease points it to one database's own pipe for the duration of
+ * a libapk call and restores previous value afterwards. Leases are
+ * serialized process-wide, so commits of different databases never
+ * write into each other's pipe; they are executed one at a time.
+ */
+class ProgressFdLease
+{
+public:
+    explicit ProgressFdLease(int fd)
+        : m_locker(&progressFdMutex)
+        , m_savedFd(w_get_apk_progress_fd())
+    {
+        w_set_apk_progress_fd(fd);
+    }
+
+    ~ProgressFdLease()
+    {
+        w_set_apk_progress_fd(m_savedFd);
+    }
+
+private:
+    QMutexLocker m_locker;
+    int m_savedFd;
+    Q_DISABLE_COPY(ProgressFdLease)
+};
+
+/**
+ * Internal struct, what is reported as DownloadProgress
+ * for one download of a fetch pool
+ */
+struct DownloadProgressContext {
+    DatabasePrivate *dbp;
+    QString url;         //! what is being downloaded
+    qint64 bytesTotal;   //! -1 if not known
+};
+
+/**
+ * Internal struct passed as void* context to w_fetch_pool_wait()
+ * callbacks, one per pool; downloads are indexed by pool job
+ */
+struct FetchPoolContext {
+    DatabasePrivate *dbp;
+    QVector<DownloadProgressContext> downloads;
+};
+
+static void cb_fetch_job_progress(void *ctx, int job, size_t bytesDone)
+{
+    FetchPoolContext *pctx = static_cast<FetchPoolContext *>(ctx);
+    const DownloadProgressContext &download = pctx->downloads.at(job);
+    pctx->dbp->report_download_progress(
+                DownloadProgress(download.url, static_cast<qint64>(bytesDone), download.bytesTotal));
+}
+
+static bool cb_fetch_cancelled(void *ctx)
+{
+    return static_cast<FetchPoolContext *>(ctx)->dbp->is_cancel_requested();
+}
+
+/**
+ * @brief upgrade_solver_flags
+ * Maps DbUpgradeFlags to libapk solver flags
+ */
+static unsigned short upgrade_solver_flags(DbUpgradeFlags flags)
+{
+    unsigned short solver_flags = APK_SOLVERF_UPGRADE;
+
+    if (flags & QTAPK_UPGRADE_AVAILABLE) solver_flags |= APK_SOLVERF_AVAILABLE;
+    if (flags & QTAPK_UPGRADE_LATEST) solver_flags |= APK_SOLVERF_LATEST;
+    return solver_flags;
+}
+
+/**
+ * @brief fill_changeset
+ * Converts solver result into our Changeset: only compact
+ * per-item information is converted, size totals are summed up
+ * during the same walk.
+ * @param db - database the changeset was solved for
+ * @param changeset - libapk's changeset filled by solver
+ * @param changes - output
+ * @param fields - package fields to convert into item packages;
+ *                 if none, packages are left empty, but item's name
+ *                 and versions are still filled in
+ */
+static void fill_changeset(struct apk_database *db, struct apk_changeset *changeset, Changeset *changes,
+                           PackageFields fields = CHANGESET_DEFAULT_FIELDS)
+{
+    const unsigned numChanges = w_apk_changeset_get_num_changes(changeset);
+    quint64 downloadSize = 0;
+    qint64 installedSizeDelta = 0;
+
+    changes->changes().clear();
+    changes->changes().reserve(static_cast<int>(numChanges));
+    changes->setNumInstall(w_apk_changeset_get_num_install(changeset));
+    changes->setNumRemove(w_apk_changeset_get_num_remove(changeset));
+    changes->setNumAdjust(w_apk_changeset_get_num_adjust(changeset));
+
+    // packages:
+    for (unsigned iChange = 0; iChange < numChanges; iChange++) {
+        struct apk_change *achange = w_apk_changeset_get_change(changeset, iChange);
+        struct apk_package *oldPkg = w_apk_change_get_old_pkg(achange);
+        struct apk_package *newPkg = w_apk_change_get_new_pkg(achange);
+        const bool reinstall = w_apk_change_is_reinstall(achange) ? true : false;
+
+        const quint64 oldInstalledSize = oldPkg ? w_apk_package_get_installedSize(oldPkg) : 0;
+        const quint64 newInstalledSize = newPkg ? w_apk_package_get_installedSize(newPkg) : 0;
+        quint64 itemDownloadSize = 0;
+        if (newPkg && (newPkg != oldPkg || reinstall) && w_apk_package_needs_download(db, newPkg)) {
+            itemDownloadSize = w_apk_package_get_size(newPkg);
+        }
+        downloadSize += itemDownloadSize;
+        installedSizeDelta += static_cast<qint64>(newInstalledSize) - static_cast<qint64>(oldInstalledSize);
+
+        if (w_apk_change_is_same_version(achange)) {
+            continue;
+        }
+
+        // one conversion per package, name and versions are always needed
+        const PackageFields itemFields = fields | QTAPK_FIELD_NAME | QTAPK_FIELD_VERSION;
+        Package oldPackage = apk_package_to_QtApkPackage(oldPkg, itemFields);
+        Package newPackage = apk_package_to_QtApkPackage(newPkg, itemFields);
+
+        ChangesetItem item;
+        item.reinstall = reinstall;
+        // strings are implicitly shared with the packages
+        item.name = newPkg ? newPackage.name : oldPackage.name;
+        item.oldVersion = oldPackage.version;
+        item.newVersion = newPackage.version;
+        if (fields) {
+            item.oldPackage = std::move(oldPackage);
+            item.newPackage = std::move(newPackage);
+        }
+        item.oldInstalledSize = oldInstalledSize;
+        item.newInstalledSize = newInstalledSize;
+        item.downloadSize = itemDownloadSize;
+        changes->changes().append(std::move(item));
+    }
+    changes->setDownloadSize(downloadSize);
+    changes->setInstalledSizeDelta(installedSizeDelta);
+}
+
+/**
+ * @brief to_utf8_list
+ * Converts strings for passing to libapk as an array of C strings.
+ * @param strs - input strings
+ * @param ptrs - output, pointers into returned byte arrays
+ * @return utf-8 copies, must be kept alive while ptrs are used
+ */
+static QVector<QByteArray> to_utf8_list(const QStringList &strs, QVector<const char *> &ptrs)
+{
+    QVector<QByteArray> ret;
+    ret.reserve(strs.size());
+    for (const QString &str : strs) {
+        ret.append(str.toUtf8());
+    }
+    ptrs.clear();
+    ptrs.reserve(ret.size());
+    for (const QByteArray &ba : ret) {
+        ptrs.append(ba.constData());
+    }
+    return ret;
+}
 
 // predefined sets of libapk database open flags
 static const unsigned long DBOPENF_READONLY = APK_OPENF_READ
@@ -41,7 +297,7 @@ DatabasePrivate::DatabasePrivate(Database *q)
 DatabasePrivate::~DatabasePrivate()
 {
     close();
-    w_set_apk_progress_fd(0);
+    // global apk_progress_fd is only set while ProgressFdLease exists
     if (progress_fd[0] != 0) ::close(progress_fd[0]);
     if (progress_fd[1] != 0) ::close(progress_fd[1]);
     progress_fd[0] = 0;
@@ -64,18 +320,34 @@ bool DatabasePrivate::open(DbOpenFlags flags)
         return false;
     }
 
-    if (flags & QTAPK_OPENF_ENABLE_PROGRESSFD) {
-        if (::pipe(progress_fd) == 0) {
-            w_set_apk_progress_fd(progress_fd[1]); // write end
+    // pipe is kept open until destruction, so reopening reuses it;
+    //    libapk gets write end only during commit, see ProgressFdLease
+    if ((flags & QTAPK_OPENF_ENABLE_PROGRESSFD) && progress_fd[0] == 0) {
+        if (::pipe(progress_fd) != 0) {
+            progress_fd[0] = 0;
+            progress_fd[1] = 0;
         }
     }
+    bump_generation();
     return true;
 }
 
 void DatabasePrivate::close()
 {
+    // plans keep pointers to package records freed
+    //    together with database, make them all invalid
+    for (PlanPrivate *plan : qAsConst(plans)) {
+        plan->db = nullptr;
+    }
+    plans.clear();
+    // indexed package records are freed together with database
+    searchIndex.clear();
+    searchIndexStale = true;
+    nameIndex.clear();
+    nameIndexStale = true;
     w_db_close(wdb);
     wdb = nullptr;
+    bump_generation();
 }
 
 bool DatabasePrivate::isOpen() const
@@ -84,7 +356,47 @@ bool DatabasePrivate::isOpen() const
     return w_db_is_open_complete(wdb->db);
 }
 
-bool DatabasePrivate::update(DbUpdateFlags flags)
+void DatabasePrivate::set_download_progress_callback(const DownloadProgressCallback &cb)
+{
+    QMutexLocker locker(&downloadProgressMutex);
+    downloadProgressCb = cb;
+}
+
+/**
+ * @brief DatabasePrivate::report_progress
+ * Sends coarse operation progress to progress channel, if one is
+ * set, otherwise writes it to progress fd as text, like libapk does.
+ * Calls must be serialized.
+ */
+void DatabasePrivate::report_progress(ProgressPhase phase, size_t done, size_t total, quint64 bytes)
+{
+    if (progressChannel) {
+        ProgressRecord rec;
+        rec.phase = phase;
+        rec.done = done;
+        rec.total = total;
+        rec.bytes = bytes;
+        progressChannel->push(rec);
+        return;
+    }
+    write_progress(progress_fd[1], done, total);
+}
+
+void DatabasePrivate::report_download_progress(const DownloadProgress &progress)
+{
+    // call a copy without holding the lock, so that callback may
+    //    replace itself or block without stalling the setter
+    DownloadProgressCallback cb;
+    {
+        QMutexLocker locker(&downloadProgressMutex);
+        cb = downloadProgressCb;
+    }
+    if (cb) {
+        cb(progress);
+    }
+}
+
+bool DatabasePrivate::update(DbUpdateFlags flags, QVector<RepositoryUpdateResult> *results)
 {
     if (!isOpen()) {
         qCWarning(LOG_QTAPK) << "update: Database is not open!";
@@ -92,17 +404,21 @@ bool DatabasePrivate::update(DbUpdateFlags flags)
     }
 
     bool res = true;
-    char progress_buf[64] = {0}; // enough for petabytes...
+    const bool allowUntrusted = (flags & QTAPK_UPDATE_ALLOW_UNTRUSTED) ? true : false;
+    const size_t numRepos = static_cast<size_t>(w_db_get_num_repos(wdb->db));
 
     // report 0%
-    int buflen;
-    if (w_get_apk_progress_fd() != 0) {
-        buflen = ::snprintf(progress_buf, sizeof(progress_buf), "0/%zu\n",
-                            static_cast<size_t>(w_db_get_num_repos(wdb->db)));
-        ::write(w_get_apk_progress_fd(), progress_buf, buflen);
+    report_progress(PROGRESS_PHASE_UPDATE, 0, numRepos);
+
+    // libapk keeps its own default max age, only override it for this update
+    const unsigned int savedMaxAge = w_db_get_cache_max_age(wdb->db);
+    if (flags & QTAPK_UPDATE_FORCE) {
+        w_db_set_cache_max_age(wdb->db, 0);
+    } else if (indexMaxAge.load() >= 0) {
+        w_db_set_cache_max_age(wdb->db, static_cast<unsigned int>(indexMaxAge.load()));
     }
 
-    // update each repo
+    QVector<int> repos;
     for (unsigned int iRepo = APK_REPOSITORY_FIRST_CONFIGURED;
          iRepo < w_db_get_num_repos(wdb->db); iRepo++)
     {
@@ -110,34 +426,103 @@ bool DatabasePrivate::update(DbUpdateFlags flags)
         if (iRepo == APK_REPOSITORY_CACHED) {
             continue;
         }
-
         qCDebug(LOG_QTAPK) << "Updating: [" << w_db_get_repo_url(wdb->db, iRepo) << "]"
                            << w_db_get_repo_desc(wdb->db, iRepo);
+        repos.append(static_cast<int>(iRepo));
+    }
+
+    // indexes are fetched by worker processes, up to UPDATE_MAX_PARALLEL
+    //    at once: total time is the time of the slowest repository,
+    //    not the sum of all of them
+    QVector<RepositoryUpdateResult> repoResults(repos.size());
+    // indexes loaded on open; fetch does not change them
+    QVector<unsigned int> counts(static_cast<int>(w_db_get_num_repos(wdb->db)), 0);
+    w_db_count_packages_by_repo(wdb->db, counts.data(), static_cast<unsigned int>(counts.size()));
+    FetchPoolContext ctx;
+    ctx.dbp = this;
+    QVector<int> resultOfJob;
+    struct w_fetch_pool *pool = w_fetch_pool_new(wdb->db, static_cast<unsigned int>(UPDATE_MAX_PARALLEL));
+    for (int i = 0; i < repos.size(); i++) {
+        RepositoryUpdateResult &repoResult = repoResults[i];
+        repoResult.url = QString::fromUtf8(w_db_get_repo_url(wdb->db, repos.at(i)));
+        repoResult.packageCount = static_cast<int>(counts.at(repos.at(i)));
+        const int job = pool ? w_fetch_pool_add_repository(pool, repos.at(i), allowUntrusted) : -ENOMEM;
+        if (job < 0) {
+            repoResult.status = job;
+            repoResult.statusString = QString::fromUtf8(w_apk_error_str(job));
+            res = false;
+            continue;
+        }
+        DownloadProgressContext progress;
+        progress.dbp = this;
+        progress.url = repoResult.url;
+        progress.bytesTotal = -1; // libapk does not tell index size
+        ctx.downloads.append(progress);
+        resultOfJob.append(i);
+    }
 
-        int r = w_db_repository_update(wdb->db, iRepo, flags & QTAPK_UPDATE_ALLOW_UNTRUSTED ? true : false);
+    // database counters, logging and progress are only
+    //    touched here, as each repository completes
+    quint64 bytesFetched = 0;
+    int numDone = 0;
+    struct w_fetch_result fetched;
+    while (pool && w_fetch_pool_wait(pool, &fetched, cb_fetch_job_progress, cb_fetch_cancelled, &ctx)) {
+        const int i = resultOfJob.at(fetched.job);
+        const int iRepo = repos.at(i);
+        int r = fetched.result;
+        if (r != -ECANCELED) {
+            w_db_repository_count_update(wdb->db, r);
+        }
+        const bool indexChanged = (r == 0);
+        if (r == -EALREADY) {
+            r = 0; // cached index is fresh enough, or not modified on server
+        }
         res = (res && (r == 0));
-        if (r != 0) {
+        if (r == -ECANCELED) {
+            qCDebug(LOG_QTAPK) << "Fetch cancelled [" << w_db_get_repo_url(wdb->db, iRepo) << "]";
+        } else if (r != 0) {
             qCWarning(LOG_QTAPK) << "Fetch failed [" << w_db_get_repo_url(wdb->db, iRepo) << "]: "
                                  << w_apk_error_str(r);
         }
 
-        // report progress to the same progress_fd that libapk uses
-        //     in exactly the same format as libapk does
-        if (w_get_apk_progress_fd() != 0) {
-            buflen = ::snprintf(progress_buf, sizeof(progress_buf), "%zu/%zu\n",
-                                static_cast<size_t>(iRepo + 1),
-                                static_cast<size_t>(w_db_get_num_repos(wdb->db)));
-            ::write(w_get_apk_progress_fd(), progress_buf, buflen);
+        RepositoryUpdateResult &repoResult = repoResults[i];
+        repoResult.status = r;
+        repoResult.statusString = QString::fromUtf8(w_apk_error_str(r));
+        repoResult.bytesFetched = indexChanged ? static_cast<qint64>(fetched.bytes) : 0;
+        repoResult.wallTimeMs = fetched.wall_time_ms;
+        repoResult.indexChanged = indexChanged;
+        if (indexChanged) {
+            repoResult.packageCount = -1; // unknown until database is reopened
         }
+
+        bytesFetched += static_cast<quint64>(repoResult.bytesFetched);
+        numDone++;
+        report_progress(PROGRESS_PHASE_UPDATE, static_cast<size_t>(APK_REPOSITORY_FIRST_CONFIGURED + numDone),
+                        numRepos, bytesFetched);
+    }
+    w_fetch_pool_free(pool);
+    w_db_set_cache_max_age(wdb->db, savedMaxAge);
+    if (is_cancel_requested()) {
+        qCDebug(LOG_QTAPK) << "update: cancelled";
+        res = false;
     }
+
+    if (results) {
+        *results = std::move(repoResults);
+    }
+
     qCDebug(LOG_QTAPK) << "Updated: " << w_db_get_repo_update_counter(wdb->db)
                        << "; Update errors: " << w_db_get_repo_update_errors(wdb->db);
     qCDebug(LOG_QTAPK) << w_db_get_get_available_packages_count(wdb->db)
                        << " distinct packages available";
+    // new packages will be added to search index on next search
+    searchIndexStale = true;
+    nameIndexStale = true;
+    bump_generation();
     return res;
 }
 
-bool DatabasePrivate::upgrade(DbUpgradeFlags flags, Changeset *changes)
+bool DatabasePrivate::upgrade(DbUpgradeFlags flags, Changeset *changes, PackageFields fields)
 {
     if (!isOpen()) {
         qCWarning(LOG_QTAPK) << "upgrade: Database is not open!";
@@ -158,10 +543,7 @@ bool DatabasePrivate::upgrade(DbUpgradeFlags flags, Changeset *changes)
         return false;
     }
 
-    unsigned short solver_flags = APK_SOLVERF_UPGRADE;
-
-    if (flags & QTAPK_UPGRADE_AVAILABLE) solver_flags |= APK_SOLVERF_AVAILABLE;
-    if (flags & QTAPK_UPGRADE_LATEST) solver_flags |= APK_SOLVERF_LATEST;
+    const unsigned short solver_flags = upgrade_solver_flags(flags);
 
     // Calculate what will be done
     r = w_apk_solver_solve(wdb->db, solver_flags, changeset);
@@ -170,22 +552,7 @@ bool DatabasePrivate::upgrade(DbUpgradeFlags flags, Changeset *changes)
 
         // fill changeset
         if (changes) {
-            changes->changes().clear();
-            changes->setNumInstall(w_apk_changeset_get_num_install(changeset));
-            changes->setNumRemove(w_apk_changeset_get_num_remove(changeset));
-            changes->setNumAdjust(w_apk_changeset_get_num_adjust(changeset));
-
-            // packages:
-            for (unsigned iChange = 0; iChange < w_apk_changeset_get_num_changes(changeset); iChange++) {
-                struct apk_change *achange = w_apk_changeset_get_change(changeset, iChange);
-                ChangesetItem item;
-                item.reinstall = w_apk_change_is_reinstall(achange) ? true : false;
-                item.oldPackage = apk_package_to_QtApkPackage(w_apk_change_get_old_pkg(achange));
-                item.newPackage = apk_package_to_QtApkPackage(w_apk_change_get_new_pkg(achange));
-                if (item.newPackage.version != item.oldPackage.version) {
-                    changes->changes().append(std::move(item));
-                }
-            }
+            fill_changeset(wdb->db, changeset, changes, fields);
         }
 
         qCDebug(LOG_QTAPK) << "To install:" << (w_apk_changeset_get_num_install(changeset))
@@ -193,9 +560,26 @@ bool DatabasePrivate::upgrade(DbUpgradeFlags flags, Changeset *changes)
                            << "; To adjust:" << (w_apk_changeset_get_num_adjust(changeset));
 
         // if we are not simulating upgrade, actually install packages
+        if (!only_simulate && (flags & QTAPK_UPGRADE_PREFETCH)) {
+            if (!prefetch_changeset(changeset, PREFETCH_DEFAULT_PARALLEL)) {
+                qCWarning(LOG_QTAPK) << "upgrade: failed to download packages";
+                w_delete_apk_changeset(changeset);
+                return false;
+            }
+        }
+        if (!only_simulate && is_cancel_requested()) {
+            qCDebug(LOG_QTAPK) << "upgrade: cancelled";
+            w_delete_apk_changeset(changeset);
+            return false;
+        }
         if (!only_simulate) {
             qCDebug(LOG_QTAPK) << "Installing...";
-            r = w_apk_solver_commit_changeset(wdb->db, changeset);
+            {
+                ProgressFdLease lease(progress_fd[1]);
+                r = w_apk_solver_commit_changeset(wdb->db, changeset);
+            }
+            // even failed commit may have changed something
+            bump_generation();
             if (r != 0) {
                 ret = false;
                 qCWarning(LOG_QTAPK) << "upgrade failed:"
@@ -230,8 +614,13 @@ bool DatabasePrivate::add(const QString &pkgNameSpec, unsigned short solver_flag
 
     struct w_resolved_apk_dependency resolved_dep;
 
-    const char *const pkgNameSpecC = pkgNameSpec.toUtf8().constData();
-    int r = w_apk_add(wdb->db, pkgNameSpecC, solver_flags, &resolved_dep);
+    // keep utf-8 copy alive while libapk uses it
+    const QByteArray pkgNameSpecUtf8 = pkgNameSpec.toUtf8();
+    int r;
+    {
+        ProgressFdLease lease(progress_fd[1]);
+        r = w_apk_add(wdb->db, pkgNameSpecUtf8.constData(), solver_flags, &resolved_dep);
+    }
 
     if (r != 0) {
         qCWarning(LOG_QTAPK) << "add: Failed to install package: "
@@ -241,6 +630,7 @@ bool DatabasePrivate::add(const QString &pkgNameSpec, unsigned short solver_flag
 
     w_resolved_dep_free_strings(&resolved_dep);
 
+    bump_generation();
     return (r == 0);
 }
 
@@ -252,60 +642,702 @@ bool DatabasePrivate::add(const QString &pkgNameSpec, unsigned short solver_flag
  * @return true on OK
  */
 bool DatabasePrivate::del(const QString &pkgNameSpec, DbDelFlags flags)
+{
+    return del(QStringList(pkgNameSpec), flags);
+}
+
+/**
+ * @brief add
+ * Adds all packages to world copy, then solves and commits once.
+ * @param pkgNameSpecs - list of package name specs, @see add(const QString &)
+ * @param flags - QTAPK_ADD_SIMULATE to only run solver
+ * @param changes - optional output for the list of changes
+ * @return true on OK
+ */
+bool DatabasePrivate::add(const QStringList &pkgNameSpecs, DbAddFlags flags, Changeset *changes)
+{
+    if (!isOpen()) {
+        qCWarning(LOG_QTAPK) << "add: Database is not open!";
+        return false;
+    }
+    if (pkgNameSpecs.isEmpty()) {
+        if (changes) *changes = Changeset();
+        return true;
+    }
+
+    Plan plan = prepare_add(pkgNameSpecs);
+    if (!plan.isValid()) {
+        return false;
+    }
+    if (changes) {
+        *changes = plan.changeset();
+    }
+    if (flags & QTAPK_ADD_SIMULATE) {
+        return true;
+    }
+    if ((flags & QTAPK_ADD_PREFETCH) && !plan.prefetch()) {
+        qCWarning(LOG_QTAPK) << "add: Failed to download packages:" << pkgNameSpecs;
+        return false;
+    }
+    if (is_cancel_requested()) {
+        qCDebug(LOG_QTAPK) << "add: cancelled";
+        return false;
+    }
+    if (!plan.commit()) {
+        qCWarning(LOG_QTAPK) << "add: Failed to install packages:" << pkgNameSpecs;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief del
+ * Removes all packages from world copy, then solves and commits once.
+ * @param pkgNameSpecs - list of package names
+ * @param flags - QTAPK_DEL_RDEPENDS applies to all packages,
+ *                QTAPK_DEL_SIMULATE to only run solver
+ * @param changes - optional output for the list of changes
+ * @return true on OK
+ */
+bool DatabasePrivate::del(const QStringList &pkgNameSpecs, DbDelFlags flags, Changeset *changes)
 {
     if (!isOpen()) {
         qCWarning(LOG_QTAPK) << "del: Database is not open!";
         return false;
     }
+    if (pkgNameSpecs.isEmpty()) {
+        if (changes) *changes = Changeset();
+        return true;
+    }
 
-    const char *const pkgname = pkgNameSpec.toUtf8().constData();
-    int r = w_apk_del(wdb->db, pkgname, flags & QTAPK_DEL_RDEPENDS ? true : false);
-    if (r) {
-        qCWarning(LOG_QTAPK) << "del: failed to delete package:" << pkgNameSpec
-                             << ": " << w_apk_error_str(r);
+    Plan plan = prepare_del(pkgNameSpecs, flags);
+    if (!plan.isValid()) {
+        return false;
+    }
+    if (changes) {
+        *changes = plan.changeset();
     }
+    if (flags & QTAPK_DEL_SIMULATE) {
+        return true;
+    }
+    if (is_cancel_requested()) {
+        qCDebug(LOG_QTAPK) << "del: cancelled";
+        return false;
+    }
+    if (!plan.commit()) {
+        qCWarning(LOG_QTAPK) << "del: failed to delete packages:" << pkgNameSpecs;
+        return false;
+    }
+    return true;
+}
+
+Plan DatabasePrivate::prepare_upgrade(DbUpgradeFlags flags)
+{
+    if (!isOpen()) {
+        qCWarning(LOG_QTAPK) << "prepareUpgrade: Database is not open!";
+        return Plan();
+    }
+    if (w_db_check_world(wdb->db) != 0) {
+        qCWarning(LOG_QTAPK) << "prepareUpgrade: Missing repository tags. Use "
+                                "--force-broken-world to override.";
+        return Plan();
+    }
+    // upgrade is solved and committed with db's own world
+    return solve_plan(nullptr, upgrade_solver_flags(flags));
+}
+
+Plan DatabasePrivate::prepare_add(const QStringList &pkgNameSpecs, unsigned short solver_flags)
+{
+    if (!isOpen()) {
+        qCWarning(LOG_QTAPK) << "prepareAdd: Database is not open!";
+        return Plan();
+    }
+
+    QVector<const char *> specPtrs;
+    const QVector<QByteArray> specsUtf8 = to_utf8_list(pkgNameSpecs, specPtrs);
+    struct apk_dependency_array *world = nullptr;
+    int failedIndex = -1;
+    int r = w_apk_prepare_add_many(wdb->db, specPtrs.constData(), specPtrs.size(),
+                                   solver_flags, &world, &failedIndex);
+    if (r != 0) {
+        qCWarning(LOG_QTAPK) << "prepareAdd: invalid package spec:" << pkgNameSpecs.value(failedIndex);
+        return Plan();
+    }
+    // same check as apk_solver_commit() does before installing
+    if (w_db_check_world_deps(wdb->db, world) != 0) {
+        qCWarning(LOG_QTAPK) << "prepareAdd: Missing repository tags. Use "
+                                "--force-broken-world to override.";
+        w_free_world(world);
+        return Plan();
+    }
+    return solve_plan(world, 0);
+}
+
+Plan DatabasePrivate::prepare_del(const QStringList &pkgNameSpecs, DbDelFlags flags)
+{
+    if (!isOpen()) {
+        qCWarning(LOG_QTAPK) << "prepareDel: Database is not open!";
+        return Plan();
+    }
+
+    QVector<const char *> namePtrs;
+    const QVector<QByteArray> namesUtf8 = to_utf8_list(pkgNameSpecs, namePtrs);
+    struct apk_dependency_array *world = nullptr;
+    int failedIndex = -1;
+    int r = w_apk_prepare_del_many(wdb->db, namePtrs.constData(), namePtrs.size(),
+                                   flags & QTAPK_DEL_RDEPENDS ? true : false,
+                                   &world, &failedIndex);
+    if (r != 0) {
+        qCWarning(LOG_QTAPK) << "prepareDel: unknown package:" << pkgNameSpecs.value(failedIndex);
+        return Plan();
+    }
+    return solve_plan(world, 0);
+}
+
+/**
+ * @brief DatabasePrivate::solve_plan
+ * Runs solver and wraps its result into a Plan.
+ * @param world - world copy to solve, Plan takes ownership;
+ *                nullptr to solve database's own world
+ * @param solver_flags - libapk solver flags
+ * @return plan, invalid if solver failed
+ */
+Plan DatabasePrivate::solve_plan(struct apk_dependency_array *world, unsigned short solver_flags)
+{
+    PlanPrivate *pd = new PlanPrivate();
+    pd->changeset = w_create_apk_changeset();
+    pd->world = world;
+
+    int r = world ? w_apk_solver_solve_world(wdb->db, solver_flags, world, pd->changeset)
+                  : w_apk_solver_solve(wdb->db, solver_flags, pd->changeset);
+    if (r == 0) {
+        fill_changeset(wdb->db, pd->changeset, &pd->changes);
+        pd->solved = true;
+        pd->generation = current_generation();
+        pd->db = this;
+        plans.insert(pd);
+    } else {
+        qCWarning(LOG_QTAPK) << "Failed to resolve world:" << w_apk_error_str(r);
+    }
+    return Plan(pd);
+}
 
+bool DatabasePrivate::commit_plan(PlanPrivate *plan)
+{
+    int r;
+    {
+        ProgressFdLease lease(progress_fd[1]);
+        r = plan->world ? w_apk_solver_commit_changeset_world(wdb->db, plan->changeset, plan->world)
+                        : w_apk_solver_commit_changeset(wdb->db, plan->changeset);
+    }
+    // this also invalidates all other plans, including this one
+    bump_generation();
+    if (r != 0) {
+        qCWarning(LOG_QTAPK) << "commit failed:" << w_apk_error_str(r);
+    }
     return (r == 0);
 }
 
-QVector<Package> DatabasePrivate::get_installed_packages() const
+void DatabasePrivate::unregister_plan(PlanPrivate *plan)
+{
+    plans.remove(plan);
+}
+
+bool DatabasePrivate::prefetch_plan(PlanPrivate *plan, int maxParallel)
+{
+    if (!prefetch_changeset(plan->changeset, maxParallel)) {
+        return false;
+    }
+    // packages are now in cache, nothing is left to download
+    fill_changeset(wdb->db, plan->changeset, &plan->changes);
+    return true;
+}
+
+/**
+ * @brief DatabasePrivate::prefetch_changeset
+ * Downloads all new packages of a solved changeset into package
+ * cache, at most maxParallel at once in worker processes, reporting
+ * progress after each package to progress fd. First failed download
+ * or cancel request stops all others. Every downloaded package is
+ * marked as cached, so that following commit reads it from cache
+ * instead of network.
+ * @param changeset - solved changeset
+ * @param maxParallel - max number of simultaneous downloads
+ * @return true if all packages are in cache now
+ */
+bool DatabasePrivate::prefetch_changeset(struct apk_changeset *changeset, int maxParallel)
+{
+    const unsigned numChanges = w_apk_changeset_get_num_changes(changeset);
+    QVector<struct apk_package *> pkgs;
+
+    for (unsigned iChange = 0; iChange < numChanges; iChange++) {
+        struct apk_change *achange = w_apk_changeset_get_change(changeset, iChange);
+        struct apk_package *oldPkg = w_apk_change_get_old_pkg(achange);
+        struct apk_package *newPkg = w_apk_change_get_new_pkg(achange);
+        if (newPkg && (newPkg != oldPkg || w_apk_change_is_reinstall(achange))
+                && w_apk_package_needs_download(wdb->db, newPkg)) {
+            pkgs.append(newPkg);
+        }
+    }
+    if (pkgs.isEmpty()) {
+        return true;
+    }
+    if (!w_db_cache_active(wdb->db)) {
+        qCWarning(LOG_QTAPK) << "prefetch: package cache is not enabled (no etc/apk/cache)";
+        return false;
+    }
+
+    struct w_fetch_pool *pool = w_fetch_pool_new(wdb->db, static_cast<unsigned int>(qMax(1, maxParallel)));
+    if (!pool) {
+        return false;
+    }
+    FetchPoolContext ctx;
+    ctx.dbp = this;
+    for (struct apk_package *pkg : pkgs) {
+        const Package p = apk_package_to_QtApkPackage(pkg, QTAPK_FIELD_NAME | QTAPK_FIELD_VERSION);
+        DownloadProgressContext progress;
+        progress.dbp = this;
+        progress.url = p.name + QLatin1Char('-') + p.version;
+        progress.bytesTotal = static_cast<qint64>(w_apk_package_get_size(pkg));
+        ctx.downloads.append(progress);
+        if (w_fetch_pool_add_package(pool, pkg) < 0) {
+            w_fetch_pool_free(pool);
+            return false;
+        }
+    }
+
+    const size_t numTotal = static_cast<size_t>(pkgs.size());
+    size_t numDone = 0;
+    quint64 bytesDone = 0;
+    bool ret = true;
+
+    report_progress(PROGRESS_PHASE_DOWNLOAD, 0, numTotal);
+
+    // package records are only modified here, in this thread
+    struct w_fetch_result fetched;
+    while (w_fetch_pool_wait(pool, &fetched, cb_fetch_job_progress, cb_fetch_cancelled, &ctx)) {
+        struct apk_package *pkg = pkgs.at(fetched.job);
+        if (fetched.result == 0) {
+            w_apk_package_set_cached(pkg);
+            bytesDone += w_apk_package_get_size(pkg);
+        } else if (fetched.result != -ECANCELED) {
+            qCWarning(LOG_QTAPK) << "prefetch: failed to download" << ctx.downloads.at(fetched.job).url
+                                 << ":" << w_apk_error_str(fetched.result);
+            // no point in downloading the rest, commit would fail anyway
+            w_fetch_pool_cancel(pool);
+        }
+        ret = ret && (fetched.result == 0);
+        numDone++;
+        report_progress(PROGRESS_PHASE_DOWNLOAD, numDone, numTotal, bytesDone);
+    }
+    w_fetch_pool_free(pool);
+    if (is_cancel_requested()) {
+        qCDebug(LOG_QTAPK) << "prefetch: cancelled";
+    }
+    return ret;
+}
+
+int DatabasePrivate::upgradeable_packages_count()
+{
+    const int gen = current_generation();
+    const qint64 fingerprint = index_fingerprint();
+
+    if (upgradeableCount >= 0 && upgradeableCountGeneration == gen
+            && upgradeableCountFingerprint == fingerprint) {
+        return upgradeableCount;
+    }
+
+    int totalUpgrades = 0;
+    Changeset changes;
+    // only totals are needed, do not fill item packages
+    if (upgrade(QTAPK_UPGRADE_SIMULATE, &changes, PackageFields())) {
+        // Don't count packages to remove
+        totalUpgrades = changes.numInstall() + changes.numAdjust();
+        upgradeableCount = totalUpgrades;
+        upgradeableCountGeneration = gen;
+        upgradeableCountFingerprint = fingerprint;
+    }
+    return totalUpgrades;
+}
+
+void DatabasePrivate::bump_generation()
+{
+    generation.ref();
+}
+
+QMap<QString, QDateTime> DatabasePrivate::repository_refresh_times() const
+{
+    QMap<QString, QDateTime> ret;
+
+    if (!isOpen()) {
+        return ret;
+    }
+    for (unsigned int iRepo = APK_REPOSITORY_FIRST_CONFIGURED;
+         iRepo < w_db_get_num_repos(wdb->db); iRepo++)
+    {
+        if (iRepo == APK_REPOSITORY_CACHED) {
+            continue;
+        }
+        const time_t mtime = w_db_get_repo_index_mtime(wdb->db, iRepo);
+        ret.insert(QString::fromUtf8(w_db_get_repo_url(wdb->db, iRepo)),
+                   mtime ? QDateTime::fromSecsSinceEpoch(static_cast<qint64>(mtime)) : QDateTime());
+    }
+    return ret;
+}
+
+/**
+ * @brief DatabasePrivate::index_fingerprint
+ * Combines modification times of cached repository indexes,
+ * so that an index refreshed by someone else is noticed.
+ * @return fingerprint value, 0 if database is not open
+ */
+qint64 DatabasePrivate::index_fingerprint() const
+{
+    qint64 ret = 0;
+
+    if (!isOpen()) {
+        return ret;
+    }
+    for (unsigned int iRepo = APK_REPOSITORY_FIRST_CONFIGURED;
+         iRepo < w_db_get_num_repos(wdb->db); iRepo++)
+    {
+        if (iRepo == APK_REPOSITORY_CACHED) {
+            continue;
+        }
+        ret = ret * 31 + static_cast<qint64>(w_db_get_repo_index_mtime(wdb->db, iRepo));
+    }
+    return ret;
+}
+
+QVector<Package> DatabasePrivate::get_installed_packages(PackageFields fields) const
 {
     QVector<Package> ret;
+    PackageConvertContext cctx = { &ret, fields };
 
     if (!w_db_has_installed(wdb->db)) {
         return ret;
     }
-    w_db_enumerate_installed(wdb->db, cb_enum_installed, reinterpret_cast<void *>(&ret));
+    w_db_enumerate_installed(wdb->db, cb_enum_installed, reinterpret_cast<void *>(&cctx));
     return ret;
 }
 
-QVector<Package> DatabasePrivate::get_available_packages() const
+QVector<Package> DatabasePrivate::get_available_packages(PackageFields fields, DbQueryFlags qflags) const
 {
+    if (qflags & QTAPK_QUERY_PARALLEL) {
+        return get_available_packages_parallel(fields);
+    }
+
     QVector<Package> ret;
+    PackageConvertContext cctx = { &ret, fields };
     ret.reserve(w_db_get_get_available_packages_count(wdb->db));
-    int r = w_db_enumerate_available(wdb->db, cb_append_package_to_vector, static_cast<void *>(&ret));
+    int r = w_db_enumerate_available(wdb->db, cb_append_package_to_vector, static_cast<void *>(&cctx));
     if (r < 0) {
         qCWarning(LOG_QTAPK) << "Failed to enumerate available packages!";
     }
     return ret;
 }
 
+QVector<Package> DatabasePrivate::get_available_packages_parallel(PackageFields fields) const
+{
+    // take a snapshot of package pointers first, it is cheap
+    QVector<struct apk_package *> pkgs;
+    pkgs.reserve(w_db_get_get_available_packages_count(wdb->db));
+    int r = w_db_enumerate_available(wdb->db, cb_append_package_ptr_to_vector, static_cast<void *>(&pkgs));
+    if (r < 0) {
+        qCWarning(LOG_QTAPK) << "Failed to enumerate available packages!";
+    }
+
+    const int total = pkgs.size();
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int maxChunks = qMin(pool->maxThreadCount(), total / PARALLEL_MIN_CHUNK_SIZE);
+    if (maxChunks < 2) {
+        // not worth it, do everything in this thread
+        return get_available_packages(fields, QTAPK_QUERY_DEFAULT);
+    }
 
-static void cb_enum_installed(struct apk_package *pkg, void *pv)
+    // output is pre-sized, so every chunk converts into its own
+    //   slice and the result has the same order as pointers snapshot
+    QVector<Package> ret(total);
+    Package *out = ret.data();
+    struct apk_package *const *in = pkgs.constData();
+    const int chunkSize = (total + maxChunks - 1) / maxChunks;
+    QSemaphore done;
+    int numChunks = 0;
+    // first chunk is converted in this thread; other chunks never wait
+    //   for a pool thread: if the pool is busy (or we are running in one
+    //   of its threads), they are converted here too, so we cannot deadlock
+    for (int begin = chunkSize; begin < total; begin += chunkSize) {
+        const int count = qMin(chunkSize, total - begin);
+        PackageConvertTask *task = new PackageConvertTask(in + begin, out + begin, count, fields, &done);
+        if (!pool->tryStart(task)) {
+            task->run();
+            delete task;
+        }
+        numChunks++;
+    }
+    PackageConvertTask(in, out, qMin(chunkSize, total), fields, &done).run();
+    numChunks++;
+    done.acquire(numChunks);
+    return ret;
+}
+
+QVector<Package> DatabasePrivate::find_package(const QString &name, PackageFields fields) const
+{
+    QVector<Package> ret;
+
+    if (!isOpen()) {
+        return ret;
+    }
+    const QByteArray nameUtf8 = name.toUtf8();
+    struct apk_name *aname = w_db_get_name(wdb->db, nameUtf8.constData());
+    if (!aname) {
+        return ret;
+    }
+    const unsigned int numProviders = w_apk_name_get_num_providers(aname);
+    ret.reserve(static_cast<int>(numProviders));
+    for (unsigned int i = 0; i < numProviders; i++) {
+        ret.append(apk_package_to_QtApkPackage(w_apk_name_get_provider(aname, i), fields));
+    }
+    return ret;
+}
+
+Package DatabasePrivate::find_installed(const QString &name, PackageFields fields) const
 {
-    QVector<Package> *ret = reinterpret_cast<QVector<Package> *>(pv);
-    ret->push_back(apk_package_to_QtApkPackage(pkg));
+    if (!isOpen()) {
+        return Package();
+    }
+    const QByteArray nameUtf8 = name.toUtf8();
+    struct apk_name *aname = w_db_get_name(wdb->db, nameUtf8.constData());
+    if (!aname) {
+        return Package();
+    }
+    // returns empty Package for nullptr
+    return apk_package_to_QtApkPackage(w_apk_name_get_installed(aname), fields);
+}
+
+QVector<UpgradeablePackage> DatabasePrivate::get_upgradeable_packages() const
+{
+    QVector<UpgradeablePackage> ret;
+
+    if (!isOpen()) {
+        return ret;
+    }
+    w_db_enumerate_upgradeable(wdb->db, cb_append_upgradeable_to_vector, static_cast<void *>(&ret));
+    return ret;
+}
+
+DependencyGraph DatabasePrivate::get_installed_dependency_graph() const
+{
+    DependencyGraphBuilder builder;
+
+    if (!isOpen()) {
+        return DependencyGraph();
+    }
+    w_db_enumerate_installed(wdb->db, cb_add_installed_to_graph, static_cast<void *>(&builder));
+    return builder.build();
+}
+
+DependencyGraph DatabasePrivate::get_available_dependency_graph() const
+{
+    DependencyGraphBuilder builder;
+
+    if (!isOpen()) {
+        return DependencyGraph();
+    }
+    w_db_enumerate_available(wdb->db, cb_add_available_to_graph, static_cast<void *>(&builder));
+    return builder.build();
+}
+
+QVector<struct apk_package *> DatabasePrivate::search_index(const QString &query, int limit) const
+{
+    if (!isOpen()) {
+        return QVector<struct apk_package *>();
+    }
+    if (searchIndexStale) {
+        // index is updated incrementally: already indexed
+        //   packages are skipped by SearchIndex
+        QVector<struct apk_package *> pkgs;
+        pkgs.reserve(w_db_get_get_available_packages_count(wdb->db));
+        w_db_enumerate_available(wdb->db, cb_append_package_ptr_to_vector, static_cast<void *>(&pkgs));
+        const int numAdded = searchIndex.addPackages(pkgs);
+        qCDebug(LOG_QTAPK) << "Search index: added" << numAdded << "packages, total"
+                           << searchIndex.size();
+        searchIndexStale = false;
+    }
+    return searchIndex.search(query, limit);
+}
+
+QVector<PackageView> DatabasePrivate::search(const QString &query, int limit) const
+{
+    QVector<PackageView> ret;
+    const QVector<struct apk_package *> found = search_index(query, limit);
+    ret.reserve(found.size());
+    for (struct apk_package *pkg : found) {
+        ret.append(PackageView(pkg));
+    }
+    return ret;
+}
+
+QVector<Package> DatabasePrivate::search_packages(const QString &query, int limit, PackageFields fields) const
+{
+    QVector<Package> ret;
+    const QVector<struct apk_package *> found = search_index(query, limit);
+    ret.reserve(found.size());
+    for (struct apk_package *pkg : found) {
+        ret.append(apk_package_to_QtApkPackage(pkg, fields));
+    }
+    return ret;
+}
+
+QStringList DatabasePrivate::complete_name(const QString &prefix, int limit) const
+{
+    if (!isOpen()) {
+        return QStringList();
+    }
+    if (nameIndexStale) {
+        QVector<QByteArray> names;
+        w_db_enumerate_names(wdb->db, cb_append_name_to_vector, static_cast<void *>(&names));
+        nameIndex.setNames(std::move(names));
+        nameIndexStale = false;
+        qCDebug(LOG_QTAPK) << "Name index: " << nameIndex.size() << "names";
+    }
+    return nameIndex.complete(prefix, limit);
+}
+
+QVector<PackageView> DatabasePrivate::get_installed_package_views() const
+{
+    QVector<PackageView> ret;
+
+    if (!isOpen() || !w_db_has_installed(wdb->db)) {
+        return ret;
+    }
+    w_db_enumerate_installed(wdb->db, cb_enum_installed_view, reinterpret_cast<void *>(&ret));
+    return ret;
+}
+
+QVector<PackageView> DatabasePrivate::get_available_package_views() const
+{
+    QVector<PackageView> ret;
+
+    if (!isOpen()) {
+        return ret;
+    }
+    ret.reserve(w_db_get_get_available_packages_count(wdb->db));
+    int r = w_db_enumerate_available(wdb->db, cb_append_view_to_vector, static_cast<void *>(&ret));
+    if (r < 0) {
+        qCWarning(LOG_QTAPK) << "Failed to enumerate available packages!";
+    }
+    return ret;
+}
+
+int DatabasePrivate::for_each_installed_package(const PackageVisitor &visitor) const
+{
+    PackageVisitorContext vctx = { &visitor, 0 };
+
+    if (!isOpen() || !visitor) {
+        return 0;
+    }
+    w_db_enumerate_installed(wdb->db, cb_visit_installed, static_cast<void *>(&vctx));
+    return vctx.numVisited;
+}
+
+int DatabasePrivate::for_each_available_package(const PackageVisitor &visitor) const
+{
+    PackageVisitorContext vctx = { &visitor, 0 };
+
+    if (!isOpen() || !visitor) {
+        return 0;
+    }
+    w_db_enumerate_available(wdb->db, cb_visit_available, static_cast<void *>(&vctx));
+    return vctx.numVisited;
+}
+
+
+static int cb_enum_installed(struct apk_package *pkg, void *pv)
+{
+    PackageConvertContext *cctx = reinterpret_cast<PackageConvertContext *>(pv);
+    cctx->vec->push_back(apk_package_to_QtApkPackage(pkg, cctx->fields));
+    return 0;
 }
 
 static int cb_append_package_to_vector(void *hash_item, void *ctx)
 {
-    QVector<Package> *vec = static_cast<QVector<Package> *>(ctx);
+    PackageConvertContext *cctx = static_cast<PackageConvertContext *>(ctx);
     struct apk_package *pkg = (struct apk_package *)hash_item;
-    vec->append(apk_package_to_QtApkPackage(pkg));
+    cctx->vec->append(apk_package_to_QtApkPackage(pkg, cctx->fields));
+    return 0;
+}
+
+static int cb_enum_installed_view(struct apk_package *pkg, void *pv)
+{
+    QVector<PackageView> *ret = reinterpret_cast<QVector<PackageView> *>(pv);
+    ret->push_back(PackageView(pkg));
+    return 0;
+}
+
+static int cb_append_view_to_vector(void *hash_item, void *ctx)
+{
+    QVector<PackageView> *vec = static_cast<QVector<PackageView> *>(ctx);
+    struct apk_package *pkg = (struct apk_package *)hash_item;
+    vec->append(PackageView(pkg));
+    return 0;
+}
+
+static int cb_append_package_ptr_to_vector(void *hash_item, void *ctx)
+{
+    QVector<struct apk_package *> *vec = static_cast<QVector<struct apk_package *> *>(ctx);
+    vec->append(static_cast<struct apk_package *>(hash_item));
+    return 0;
+}
+
+static int cb_append_upgradeable_to_vector(struct apk_package *old_pkg,
+                                           struct apk_package *new_pkg, void *ctx)
+{
+    QVector<UpgradeablePackage> *vec = static_cast<QVector<UpgradeablePackage> *>(ctx);
+    vec->append(UpgradeablePackage(QString::fromUtf8(w_apk_package_get_pkg_name(old_pkg)),
+                                   QString::fromUtf8(w_apk_package_get_version(old_pkg)),
+                                   QString::fromUtf8(w_apk_package_get_version(new_pkg))));
+    return 0;
+}
+
+static int cb_add_installed_to_graph(struct apk_package *pkg, void *ctx)
+{
+    static_cast<DependencyGraphBuilder *>(ctx)->addPackage(pkg);
+    return 0;
+}
+
+static int cb_add_available_to_graph(void *hash_item, void *ctx)
+{
+    static_cast<DependencyGraphBuilder *>(ctx)->addPackage(static_cast<struct apk_package *>(hash_item));
     return 0;
 }
 
-static Package apk_package_to_QtApkPackage(struct apk_package *pkg)
+static int cb_append_name_to_vector(void *hash_item, void *ctx)
+{
+    QVector<QByteArray> *vec = static_cast<QVector<QByteArray> *>(ctx);
+    struct apk_name *name = static_cast<struct apk_name *>(hash_item);
+    // skip names that are only referenced as dependencies,
+    //    but nothing can actually be installed for them
+    if (w_apk_name_get_num_providers(name) > 0) {
+        vec->append(QByteArray(w_apk_name_get_name(name)));
+    }
+    return 0;
+}
+
+static int cb_visit_installed(struct apk_package *pkg, void *ctx)
+{
+    PackageVisitorContext *vctx = static_cast<PackageVisitorContext *>(ctx);
+    vctx->numVisited++;
+    // non-zero return value stops enumeration
+    return (*vctx->visitor)(PackageView(pkg)) ? 0 : 1;
+}
+
+static int cb_visit_available(void *hash_item, void *ctx)
+{
+    return cb_visit_installed(static_cast<struct apk_package *>(hash_item), ctx);
+}
+
+Package apk_package_to_QtApkPackage(struct apk_package *pkg, PackageFields fields)
 {
     Package qpkg;
 
@@ -313,19 +1345,32 @@ static Package apk_package_to_QtApkPackage(struct apk_package *pkg)
         return qpkg;
     }
 
-    qpkg.name = QString::fromUtf8(w_apk_package_get_pkg_name(pkg));
-    qpkg.version = QString::fromUtf8(w_apk_package_get_version(pkg));
-    qpkg.arch = QString::fromUtf8(w_apk_package_get_arch(pkg));
-    qpkg.license = QString::fromUtf8(w_apk_package_get_license(pkg));
-    qpkg.origin = QString::fromUtf8(w_apk_package_get_origin(pkg));
-    qpkg.maintainer = QString::fromUtf8(w_apk_package_get_maintainer(pkg));
-    qpkg.url = QString::fromUtf8(w_apk_package_get_url(pkg));
-    qpkg.description = QString::fromUtf8(w_apk_package_get_description(pkg));
-    qpkg.commit = QString::fromUtf8(w_apk_package_get_commit(pkg));
-    qpkg.filename = QString::fromUtf8(w_apk_package_get_filename(pkg));
-    qpkg.buildTime = QDateTime::fromSecsSinceEpoch(w_apk_package_get_buildTime(pkg), Qt::UTC);
-    qpkg.installedSize = w_apk_package_get_installedSize(pkg);
-    qpkg.size = w_apk_package_get_size(pkg);
+    if (fields & QTAPK_FIELD_NAME)
+        qpkg.name = QString::fromUtf8(w_apk_package_get_pkg_name(pkg));
+    if (fields & QTAPK_FIELD_VERSION)
+        qpkg.version = QString::fromUtf8(w_apk_package_get_version(pkg));
+    if (fields & QTAPK_FIELD_ARCH)
+        qpkg.arch = QString::fromUtf8(w_apk_package_get_arch(pkg));
+    if (fields & QTAPK_FIELD_LICENSE)
+        qpkg.license = QString::fromUtf8(w_apk_package_get_license(pkg));
+    if (fields & QTAPK_FIELD_ORIGIN)
+        qpkg.origin = QString::fromUtf8(w_apk_package_get_origin(pkg));
+    if (fields & QTAPK_FIELD_MAINTAINER)
+        qpkg.maintainer = QString::fromUtf8(w_apk_package_get_maintainer(pkg));
+    if (fields & QTAPK_FIELD_URL)
+        qpkg.url = QString::fromUtf8(w_apk_package_get_url(pkg));
+    if (fields & QTAPK_FIELD_DESCRIPTION)
+        qpkg.description = QString::fromUtf8(w_apk_package_get_description(pkg));
+    if (fields & QTAPK_FIELD_COMMIT)
+        qpkg.commit = QString::fromUtf8(w_apk_package_get_commit(pkg));
+    if (fields & QTAPK_FIELD_FILENAME)
+        qpkg.filename = QString::fromUtf8(w_apk_package_get_filename(pkg));
+    if (fields & QTAPK_FIELD_BUILDTIME)
+        qpkg.buildTime = QDateTime::fromSecsSinceEpoch(w_apk_package_get_buildTime(pkg), Qt::UTC);
+    if (fields & QTAPK_FIELD_SIZES) {
+        qpkg.installedSize = w_apk_package_get_installedSize(pkg);
+        qpkg.size = w_apk_package_get_size(pkg);
+    }
     return qpkg;
 }
 
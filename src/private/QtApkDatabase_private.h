@@ -3,24 +3,56 @@
 #ifndef H_QTAPK_DB_PRIV
 #define H_QTAPK_DB_PRIV
 
+#include <QAtomicInt>
+#include <QDateTime>
+#include <QMap>
+#include <QSet>
 #include <QString>
+#include <QStringList>
 #include <QVector>
 #include <QLoggingCategory>
+#include <QMutex>
 
 #include "../QtApkDatabase.h"
 #include "../QtApkPackage.h"
+#include "../QtApkPackageView.h"
+#include "../QtApkPlan.h"
 #include "../QtApkRepository.h"
+#include "../QtApkRepositoryUpdateResult.h"
 #include "../QtApkChangeset.h"
+#include "../QtApkDependencyGraph.h"
+#include "../QtApkUpgradeablePackage.h"
+#include "QtApkNameIndex.h"
+#include "QtApkProgressChannel.h"
+#include "QtApkSearchIndex.h"
 
 Q_DECLARE_LOGGING_CATEGORY(LOG_QTAPK)
 
 //  libapk wrapper's forward decls
 struct w_apk_database;
+struct apk_package;
+struct apk_dependency_array;
+struct apk_changeset;
 
 
 namespace QtApk {
 
 class DatabaseAsyncPrivate;  // forward decl, we need to add it as friend
+class PlanPrivate;
+
+// converts libapk's package record into our Package, only the
+// requested fields are converted; also used by PackageView::toPackage()
+Package apk_package_to_QtApkPackage(struct apk_package *pkg,
+                                    PackageFields fields = QTAPK_FIELD_ALL);
+
+// default number of simultaneous downloads for prefetch
+static const int PREFETCH_DEFAULT_PARALLEL = 4;
+
+// max number of repository indexes fetched at once by update()
+static const int UPDATE_MAX_PARALLEL = 8;
+
+// package fields converted into ChangesetItem's packages by default
+static const PackageFields CHANGESET_DEFAULT_FIELDS = QTAPK_FIELD_NAME | QTAPK_FIELD_VERSION | QTAPK_FIELD_ARCH;
 
 class DatabasePrivate
 {
@@ -30,12 +62,63 @@ public:
 
     // return read end of the pipe
     int progressFd() const { return progress_fd[0]; }
+    void set_download_progress_callback(const DownloadProgressCallback &cb);
+    // only set while no operation is running; libapk itself
+    //    still writes commit progress to progress fd
+    void set_progress_channel(ProgressChannel *channel) { progressChannel = channel; }
+    void report_progress(ProgressPhase phase, size_t done, size_t total, quint64 bytes = 0);
+    // called from the thread that waits for a fetch pool
+    void report_download_progress(const DownloadProgress &progress);
     bool open(DbOpenFlags flags);
     void close();
     bool isOpen() const;
-    bool update(DbUpdateFlags flags);
+    bool update(DbUpdateFlags flags, QVector<RepositoryUpdateResult> *results = nullptr);
     bool upgrade(DbUpgradeFlags flags = QTAPK_UPGRADE_DEFAULT,
-                 Changeset *changes = nullptr);
+                 Changeset *changes = nullptr,
+                 PackageFields fields = CHANGESET_DEFAULT_FIELDS);
+
+    /**
+     * @brief upgradeable_packages_count
+     * Runs simulated upgrade and counts packages to install
+     * or adjust. Result is cached until database generation
+     * or repository index files change.
+     * @return number of packages that can be upgraded
+     */
+    int upgradeable_packages_count();
+
+    /**
+     * @brief set_index_max_age
+     * Can be called from any thread, used by next update()
+     * @param secs - repository indexes younger than that are not
+     *               fetched again by update(); -1 for libapk's default
+     */
+    void set_index_max_age(int secs) { indexMaxAge.store(secs < 0 ? -1 : secs); }
+    int index_max_age() const { return indexMaxAge.load(); }
+
+    /**
+     * @brief repository_refresh_times
+     * @return repository url => modification time of its cached
+     *         index, invalid QDateTime if there is no cached index
+     */
+    QMap<QString, QDateTime> repository_refresh_times() const;
+
+    /**
+     * @brief current_generation
+     * @return counter that is changed every time database state
+     *         changes: open/close, update, add, del, upgrade commit
+     */
+    int current_generation() const { return generation.load(); }
+
+    /**
+     * @brief request_cancel
+     * Asks running update(), upgrade(), add() or del() to stop at
+     * the next safe point: between repositories, between or during
+     * downloads, before commit. Commit itself is never interrupted.
+     * Can be called from any thread; flag stays set until reset_cancel().
+     */
+    void request_cancel() { cancelRequested.store(1); }
+    void reset_cancel() { cancelRequested.store(0); }
+    bool is_cancel_requested() const { return cancelRequested.load() != 0; }
 
     /**
      * @brief add
@@ -55,10 +138,44 @@ public:
      */
     bool del(const QString &pkgNameSpec, DbDelFlags flags);
 
-    QVector<Package> get_installed_packages() const;
-    QVector<Package> get_available_packages() const;
+    bool add(const QStringList &pkgNameSpecs, DbAddFlags flags = QTAPK_ADD_DEFAULT,
+             Changeset *changes = nullptr);
+    bool del(const QStringList &pkgNameSpecs, DbDelFlags flags,
+             Changeset *changes = nullptr);
+
+    Plan prepare_upgrade(DbUpgradeFlags flags);
+    Plan prepare_add(const QStringList &pkgNameSpecs, unsigned short solver_flags = 0);
+    Plan prepare_del(const QStringList &pkgNameSpecs, DbDelFlags flags);
+    // used by Plan
+    bool commit_plan(PlanPrivate *plan);
+    void unregister_plan(PlanPrivate *plan);
+    bool prefetch_plan(PlanPrivate *plan, int maxParallel);
+
+    QVector<Package> get_installed_packages(PackageFields fields = QTAPK_FIELD_ALL) const;
+    QVector<Package> get_available_packages(PackageFields fields = QTAPK_FIELD_ALL,
+                                            DbQueryFlags qflags = QTAPK_QUERY_DEFAULT) const;
+    QVector<Package> find_package(const QString &name, PackageFields fields = QTAPK_FIELD_ALL) const;
+    Package find_installed(const QString &name, PackageFields fields = QTAPK_FIELD_ALL) const;
+    QVector<UpgradeablePackage> get_upgradeable_packages() const;
+    DependencyGraph get_installed_dependency_graph() const;
+    DependencyGraph get_available_dependency_graph() const;
+    QVector<PackageView> search(const QString &query, int limit) const;
+    // same as search(), but results are copies, safe to hand over to other threads
+    QVector<Package> search_packages(const QString &query, int limit, PackageFields fields) const;
+    QStringList complete_name(const QString &prefix, int limit) const;
+    QVector<PackageView> get_installed_package_views() const;
+    QVector<PackageView> get_available_package_views() const;
+    int for_each_installed_package(const PackageVisitor &visitor) const;
+    int for_each_available_package(const PackageVisitor &visitor) const;
 
 private:
+    QVector<Package> get_available_packages_parallel(PackageFields fields) const;
+    QVector<struct apk_package *> search_index(const QString &query, int limit) const;
+    Plan solve_plan(struct apk_dependency_array *world, unsigned short solver_flags);
+    bool prefetch_changeset(struct apk_changeset *changeset, int maxParallel);
+    void bump_generation();
+    qint64 index_fingerprint() const;
+
     // Qt's PIMPL members
     Database *q_ptr = nullptr;
     Q_DECLARE_PUBLIC(Database)
@@ -69,6 +186,28 @@ private:
 
     struct w_apk_database *wdb = nullptr;
     int progress_fd[2];
+
+    // full-text search index, built lazily on first search
+    mutable SearchIndex searchIndex;
+    mutable bool searchIndexStale = true; //! true if there may be unindexed packages
+
+    // sorted names for type-ahead completion, built lazily
+    mutable NameIndex nameIndex;
+    mutable bool nameIndexStale = true;
+
+    QMutex downloadProgressMutex; //! protects downloadProgressCb
+    DownloadProgressCallback downloadProgressCb;
+    ProgressChannel *progressChannel = nullptr; //! see report_progress()
+
+    QAtomicInt generation; //! see current_generation()
+    QAtomicInt indexMaxAge {-1}; //! see set_index_max_age()
+    QAtomicInt cancelRequested {0}; //! see request_cancel()
+    QSet<PlanPrivate *> plans; //! live plans, detached on close()
+
+    // cached upgradeable_packages_count() result and its keys
+    int upgradeableCount = -1;
+    int upgradeableCountGeneration = -1;
+    qint64 upgradeableCountFingerprint = 0;
 };
 
 } // namespace QtApk
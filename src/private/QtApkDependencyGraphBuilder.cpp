@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "QtApkDependencyGraphBuilder.h"
+#include "libapk_c_wrappers.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace QtApk {
+
+// C wrapper reports edge kinds as enum w_dep_kind, stored as is
+static_assert(static_cast<int>(W_DEP_DEPENDS) == QTAPK_DEP_DEPENDS, "enum mismatch");
+static_assert(static_cast<int>(W_DEP_PROVIDES) == QTAPK_DEP_PROVIDES, "enum mismatch");
+static_assert(static_cast<int>(W_DEP_INSTALL_IF) == QTAPK_DEP_INSTALL_IF, "enum mismatch");
+static_assert(static_cast<int>(W_DEP_CONFLICTS) == QTAPK_DEP_CONFLICTS, "enum mismatch");
+
+
+void DependencyGraphBuilder::addPackage(struct apk_package *pkg)
+{
+    const int node = nodeFor(w_apk_package_get_name(pkg));
+    m_isPackage[node] = 1;
+    w_apk_package_enumerate_deps(pkg, cb_add_edge, static_cast<void *>(this));
+}
+
+DependencyGraph DependencyGraphBuilder::build() const
+{
+    DependencyGraph graph;
+    const int numNodes = m_nodes.size();
+
+    // final node ids are assigned in name order, so that
+    //    DependencyGraph::nodeId() can use binary search
+    QVector<int> order(numNodes);
+    for (int i = 0; i < numNodes; i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return std::strcmp(w_apk_name_get_name(m_nodes.at(a)),
+                           w_apk_name_get_name(m_nodes.at(b))) < 0;
+    });
+    QVector<int> newId(numNodes);
+    graph.m_nameOffsets.resize(numNodes);
+    graph.m_isPackage.resize(numNodes);
+    for (int i = 0; i < numNodes; i++) {
+        const int oldId = order.at(i);
+        const char *name = w_apk_name_get_name(m_nodes.at(oldId));
+        newId[oldId] = i;
+        graph.m_nameOffsets[i] = graph.m_names.size();
+        graph.m_names.append(name, static_cast<int>(std::strlen(name)) + 1);
+        graph.m_isPackage[i] = m_isPackage.at(oldId);
+    }
+
+    QVector<Edge> edges = m_edges;
+    for (Edge &e : edges) {
+        e.from = newId.at(e.from);
+        e.to = newId.at(e.to);
+    }
+    // packages with several versions give many identical edges
+    std::sort(edges.begin(), edges.end(), [](const Edge &a, const Edge &b) {
+        if (a.from != b.from) return a.from < b.from;
+        if (a.to != b.to) return a.to < b.to;
+        return a.kind < b.kind;
+    });
+    edges.erase(std::unique(edges.begin(), edges.end(), [](const Edge &a, const Edge &b) {
+        return a.from == b.from && a.to == b.to && a.kind == b.kind;
+    }), edges.end());
+
+    fillCsr(edges, numNodes, false, graph.m_offsets, graph.m_targets, graph.m_kinds);
+    fillCsr(edges, numNodes, true, graph.m_reverseOffsets, graph.m_reverseTargets, graph.m_reverseKinds);
+    return graph;
+}
+
+int DependencyGraphBuilder::nodeFor(struct apk_name *name)
+{
+    const auto it = m_nodeIds.constFind(name);
+    if (it != m_nodeIds.constEnd()) {
+        return it.value();
+    }
+    const int node = m_nodes.size();
+    m_nodeIds.insert(name, node);
+    m_nodes.append(name);
+    m_isPackage.append(0);
+    return node;
+}
+
+int DependencyGraphBuilder::cb_add_edge(struct apk_name *from, struct apk_name *to, int kind, void *ctx)
+{
+    DependencyGraphBuilder *builder = static_cast<DependencyGraphBuilder *>(ctx);
+    Edge e;
+    e.from = builder->nodeFor(from);
+    e.to = builder->nodeFor(to);
+    e.kind = static_cast<quint8>(kind);
+    builder->m_edges.append(e);
+    return 0;
+}
+
+/**
+ * @brief DependencyGraphBuilder::fillCsr
+ * Counting sort of edges by source (or by target, if reverse),
+ * edges must be unique and sorted by (from, to, kind); stable
+ * placement keeps the other end sorted within each row.
+ */
+void DependencyGraphBuilder::fillCsr(const QVector<Edge> &edges, int numNodes, bool reverse,
+                                     QVector<int> &offsets, QVector<int> &targets, QVector<quint8> &kinds)
+{
+    offsets.fill(0, numNodes + 1);
+    for (const Edge &e : edges) {
+        offsets[(reverse ? e.to : e.from) + 1]++;
+    }
+    for (int i = 0; i < numNodes; i++) {
+        offsets[i + 1] += offsets.at(i);
+    }
+
+    targets.resize(edges.size());
+    kinds.resize(edges.size());
+    QVector<int> pos = offsets;
+    for (const Edge &e : edges) {
+        const int row = reverse ? e.to : e.from;
+        const int i = pos[row]++;
+        targets[i] = reverse ? e.from : e.to;
+        kinds[i] = e.kind;
+    }
+}
+
+} // namespace QtApk
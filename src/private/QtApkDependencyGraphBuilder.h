@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef H_QTAPK_DEPENDENCY_GRAPH_BUILDER
+#define H_QTAPK_DEPENDENCY_GRAPH_BUILDER
+
+#include <QHash>
+#include <QVector>
+
+#include "../QtApkDependencyGraph.h"
+
+//  libapk forward decls
+struct apk_name;
+struct apk_package;
+
+namespace QtApk {
+
+/**
+ * @brief The DependencyGraphBuilder class
+ * Collects dependency edges of packages directly from libapk's
+ * dependency arrays, then packs them into a DependencyGraph.
+ * Only valid while database is open.
+ */
+class DependencyGraphBuilder
+{
+public:
+    /**
+     * @brief addPackage
+     * Add package node and all its depends, provides
+     * and install_if edges.
+     * @param pkg - libapk package
+     */
+    void addPackage(struct apk_package *pkg);
+
+    /**
+     * @brief build
+     * Sort nodes by name, remove duplicate edges and
+     * create forward and reverse CSR arrays.
+     * @return standalone graph
+     */
+    DependencyGraph build() const;
+
+private:
+    struct Edge {
+        int from;
+        int to;
+        quint8 kind;
+    };
+
+    int nodeFor(struct apk_name *name);
+    static int cb_add_edge(struct apk_name *from, struct apk_name *to, int kind, void *ctx);
+    static void fillCsr(const QVector<Edge> &edges, int numNodes, bool reverse,
+                        QVector<int> &offsets, QVector<int> &targets, QVector<quint8> &kinds);
+
+    QHash<struct apk_name *, int> m_nodeIds; //! libapk name => temporary node id
+    QVector<struct apk_name *> m_nodes;      //! temporary node id => libapk name
+    QVector<quint8> m_isPackage;
+    QVector<Edge> m_edges;
+};
+
+} // namespace QtApk
+
+#endif
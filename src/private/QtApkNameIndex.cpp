@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "QtApkNameIndex.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace QtApk {
+
+
+void NameIndex::clear()
+{
+    m_names.clear();
+}
+
+void NameIndex::setNames(QVector<QByteArray> names)
+{
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    names.squeeze();
+    m_names = std::move(names);
+}
+
+QStringList NameIndex::complete(const QString &prefix, int limit) const
+{
+    QStringList ret;
+    const QByteArray prefixUtf8 = prefix.toUtf8();
+
+    // first name that is not less than prefix is where
+    //    all names starting with prefix begin
+    QVector<QByteArray>::const_iterator it = std::lower_bound(
+                m_names.constBegin(), m_names.constEnd(), prefixUtf8);
+    while (it != m_names.constEnd() && ret.size() < limit) {
+        if (!it->startsWith(prefixUtf8)) {
+            break;
+        }
+        ret.append(QString::fromUtf8(*it));
+        ++it;
+    }
+    return ret;
+}
+
+
+} // namespace QtApk
@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef H_QTAPK_NAME_INDEX
+#define H_QTAPK_NAME_INDEX
+
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+
+namespace QtApk {
+
+/**
+ * @brief The NameIndex class
+ * Sorted array of all package names known to database (including
+ * provided names like "so:..." and "cmd:..."), used for prefix
+ * completion by Database::completeName().
+ *
+ * Names are stored as UTF-8, so that sort order and prefix
+ * comparison are plain byte-wise operations.
+ *
+ * Not thread-safe.
+ */
+class NameIndex
+{
+public:
+    /**
+     * @brief clear
+     * Forget all names.
+     */
+    void clear();
+
+    /**
+     * @brief setNames
+     * Replace index contents.
+     * @param names - UTF-8 names, in any order, duplicates allowed
+     */
+    void setNames(QVector<QByteArray> names);
+
+    /**
+     * @brief complete
+     * @param prefix - name prefix, case-sensitive
+     * @param limit - max number of results to return
+     * @return names starting with prefix, in byte-wise sorted order
+     */
+    QStringList complete(const QString &prefix, int limit) const;
+
+    /**
+     * @brief size
+     * @return number of indexed names
+     */
+    int size() const { return m_names.size(); }
+
+private:
+    QVector<QByteArray> m_names; //! sorted, unique
+};
+
+} // namespace QtApk
+
+#endif
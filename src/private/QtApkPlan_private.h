@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef H_QTAPK_PLAN_PRIVATE
+#define H_QTAPK_PLAN_PRIVATE
+
+#include "../QtApkPlan.h"
+#include "../QtApkChangeset.h"
+
+//  libapk forward decls
+struct apk_changeset;
+struct apk_dependency_array;
+
+namespace QtApk {
+
+class DatabasePrivate;
+
+class PlanPrivate
+{
+public:
+    ~PlanPrivate();
+
+    DatabasePrivate *db = nullptr;           //! reset to nullptr when database closes
+    struct apk_changeset *changeset = nullptr;
+    struct apk_dependency_array *world = nullptr; //! owned world copy, or nullptr to use db world
+    int generation = 0;                      //! database generation at solve time
+    bool solved = false;
+    Changeset changes;
+};
+
+} // namespace QtApk
+
+#endif
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "QtApkProgressChannel.h"
+
+namespace QtApk {
+
+bool ProgressChannel::push(const ProgressRecord &rec)
+{
+    // new record supersedes the one kept aside, if any
+    m_hasPending = false;
+    if (!tryPush(rec)) {
+        m_pending = rec;
+        m_hasPending = true;
+        return false;
+    }
+    return true;
+}
+
+bool ProgressChannel::flush()
+{
+    if (m_hasPending && tryPush(m_pending)) {
+        m_hasPending = false;
+    }
+    return !m_hasPending;
+}
+
+int ProgressChannel::drain(ProgressRecord *latest)
+{
+    const quint32 tail = m_tail.load();
+    const quint32 head = m_head.loadAcquire(); // see records written before head
+    if (head == tail) {
+        return 0;
+    }
+    *latest = m_ring[(head - 1) & (CAPACITY - 1)];
+    m_tail.storeRelease(head); // slots can be reused after this
+    return static_cast<int>(head - tail);
+}
+
+bool ProgressChannel::tryPush(const ProgressRecord &rec)
+{
+    const quint32 head = m_head.load();
+    const quint32 tail = m_tail.loadAcquire(); // consumer is done with slots before tail
+    if (head - tail >= CAPACITY) {
+        return false;
+    }
+    m_ring[head & (CAPACITY - 1)] = rec;
+    m_head.storeRelease(head + 1); // publish the record
+    return true;
+}
+
+} // namespace QtApk
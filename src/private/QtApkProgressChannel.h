@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef H_QTAPK_PROGRESS_CHANNEL
+#define H_QTAPK_PROGRESS_CHANNEL
+
+#include <QAtomicInteger>
+#include <QtGlobal>
+
+namespace QtApk {
+
+/**
+ * @brief The ProgressPhase enum
+ * What a ProgressRecord is about
+ */
+enum ProgressPhase : quint32 {
+    PROGRESS_PHASE_NONE = 0,
+    PROGRESS_PHASE_UPDATE = 1,   //! fetching repository indexes, done/total are repositories
+    PROGRESS_PHASE_DOWNLOAD = 2, //! prefetching packages, done/total are packages
+    PROGRESS_PHASE_COMMIT = 3,   //! libapk installing/removing, units are libapk's own
+};
+
+/**
+ * @brief The ProgressRecord struct
+ * One fixed-size progress update
+ */
+struct ProgressRecord {
+    quint32 phase = PROGRESS_PHASE_NONE; //! ProgressPhase
+    quint64 done = 0;
+    quint64 total = 0;
+    quint64 bytes = 0;                   //! bytes downloaded so far in this phase
+};
+
+/**
+ * @brief The ProgressChannel class
+ * Lock-free single-producer single-consumer ring of progress
+ * records. Producer is the thread executing database operation
+ * (or several threads, if they are serialized by their own mutex),
+ * consumer is the thread that shows progress.
+ *
+ * Only the latest state is interesting to consumer, so updates
+ * are coalesced on both ends: if ring is full, producer keeps
+ * the newest record aside and pushes it with the next one, or
+ * on flush(); consumer drains everything at once and only looks
+ * at the last record.
+ */
+class ProgressChannel
+{
+public:
+    static const quint32 CAPACITY = 256; //! must be a power of two
+
+    /**
+     * @brief push
+     * Producer side. Never blocks.
+     * @param rec - record to send
+     * @return false if ring is full and record was kept aside
+     */
+    bool push(const ProgressRecord &rec);
+
+    /**
+     * @brief flush
+     * Producer side. Tries to send a record kept aside by push().
+     * @return true if nothing is left aside
+     */
+    bool flush();
+
+    /**
+     * @brief drain
+     * Consumer side. Never blocks.
+     * @param latest - output, last record received, not touched if none
+     * @return number of records received
+     */
+    int drain(ProgressRecord *latest);
+
+private:
+    bool tryPush(const ProgressRecord &rec);
+
+    ProgressRecord m_ring[CAPACITY];
+    QAtomicInteger<quint32> m_head {0}; //! next slot to write, changed by producer
+    QAtomicInteger<quint32> m_tail {0}; //! next slot to read, changed by consumer
+
+    // producer only
+    ProgressRecord m_pending;
+    bool m_hasPending = false;
+};
+
+} // namespace QtApk
+
+#endif
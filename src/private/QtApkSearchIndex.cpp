@@ -0,0 +1,220 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "QtApkSearchIndex.h"
+#include "QtApkDatabase_private.h"
+
+#include <QPair>
+#include <QStringList>
+
+#include <algorithm>
+#include <iterator>
+
+namespace QtApk {
+
+static const int TRIGRAM_LEN = 3;
+
+// ranking weights for a single query term
+static const int SCORE_NAME_EXACT = 100;
+static const int SCORE_NAME_PREFIX = 60;
+static const int SCORE_NAME_CONTAINS = 40;
+static const int SCORE_ORIGIN_CONTAINS = 20;
+static const int SCORE_DESCRIPTION_CONTAINS = 10;
+
+
+void SearchIndex::clear()
+{
+    m_docs.clear();
+    m_postings.clear();
+    m_indexed.clear();
+}
+
+int SearchIndex::addPackages(const QVector<struct apk_package *> &pkgs)
+{
+    int numAdded = 0;
+    QSet<quint64> trigrams;
+
+    for (struct apk_package *pkg : pkgs) {
+        if (m_indexed.contains(pkg)) {
+            continue;
+        }
+        m_indexed.insert(pkg);
+
+        const Package p = apk_package_to_QtApkPackage(
+                    pkg, QTAPK_FIELD_NAME | QTAPK_FIELD_ORIGIN | QTAPK_FIELD_DESCRIPTION);
+        Document doc;
+        doc.pkg = pkg;
+        doc.name = p.name.toLower();
+        doc.origin = p.origin.toLower();
+        doc.description = p.description.toLower();
+
+        // trigrams are collected per field, so that no
+        //    trigrams spanning across field borders are created
+        trigrams.clear();
+        collectTrigrams(doc.name, trigrams);
+        collectTrigrams(doc.origin, trigrams);
+        collectTrigrams(doc.description, trigrams);
+
+        // document ids only grow, so posting lists stay sorted
+        const int docId = m_docs.size();
+        for (const quint64 key : trigrams) {
+            m_postings[key].append(docId);
+        }
+        m_docs.append(std::move(doc));
+        numAdded++;
+    }
+    return numAdded;
+}
+
+QVector<struct apk_package *> SearchIndex::search(const QString &query, int limit) const
+{
+    QVector<struct apk_package *> ret;
+    const QString q = query.simplified().toLower();
+
+    if (q.isEmpty() || m_docs.isEmpty() || limit <= 0) {
+        return ret;
+    }
+    const QStringList terms = q.split(QLatin1Char(' '));
+
+    // narrow down the set of documents using trigrams of each term;
+    //    terms shorter than a trigram are only checked below
+    QVector<int> candidates;
+    bool haveCandidates = false;
+    for (const QString &term : terms) {
+        if (term.length() < TRIGRAM_LEN) {
+            continue;
+        }
+        const QVector<int> termDocs = candidatesFor(term);
+        if (!haveCandidates) {
+            candidates = termDocs;
+            haveCandidates = true;
+        } else {
+            QVector<int> both;
+            std::set_intersection(candidates.constBegin(), candidates.constEnd(),
+                                  termDocs.constBegin(), termDocs.constEnd(),
+                                  std::back_inserter(both));
+            candidates = both;
+        }
+        if (candidates.isEmpty()) {
+            return ret;
+        }
+    }
+    if (!haveCandidates) {
+        // only short terms, have to look at every document
+        candidates.resize(m_docs.size());
+        for (int i = 0; i < m_docs.size(); i++) {
+            candidates[i] = i;
+        }
+    }
+
+    // trigrams can give false positives, so check every candidate
+    //    for real and rank it: (score, document id)
+    QVector<QPair<int, int>> scored;
+    for (const int docId : candidates) {
+        const Document &doc = m_docs.at(docId);
+        int score = 0;
+        for (const QString &term : terms) {
+            const int termScore = scoreTerm(doc, term);
+            if (termScore == 0) {
+                score = 0;
+                break;
+            }
+            score += termScore;
+        }
+        if (score > 0) {
+            scored.append(qMakePair(score, docId));
+        }
+    }
+
+    // best score first, then shorter names, then alphabetically
+    std::sort(scored.begin(), scored.end(),
+              [this](const QPair<int, int> &a, const QPair<int, int> &b) {
+        if (a.first != b.first) {
+            return a.first > b.first;
+        }
+        const QString &nameA = m_docs.at(a.second).name;
+        const QString &nameB = m_docs.at(b.second).name;
+        if (nameA.length() != nameB.length()) {
+            return nameA.length() < nameB.length();
+        }
+        if (nameA != nameB) {
+            return nameA < nameB;
+        }
+        return a.second < b.second;
+    });
+
+    const int numResults = qMin(limit, scored.size());
+    ret.reserve(numResults);
+    for (int i = 0; i < numResults; i++) {
+        ret.append(m_docs.at(scored.at(i).second).pkg);
+    }
+    return ret;
+}
+
+void SearchIndex::collectTrigrams(const QString &text, QSet<quint64> &out)
+{
+    for (int i = 0; i + TRIGRAM_LEN <= text.length(); i++) {
+        const quint64 key = (static_cast<quint64>(text.at(i).unicode()) << 32)
+                | (static_cast<quint64>(text.at(i + 1).unicode()) << 16)
+                | static_cast<quint64>(text.at(i + 2).unicode());
+        out.insert(key);
+    }
+}
+
+int SearchIndex::scoreTerm(const Document &doc, const QString &term)
+{
+    if (doc.name == term) {
+        return SCORE_NAME_EXACT;
+    }
+    if (doc.name.startsWith(term)) {
+        return SCORE_NAME_PREFIX;
+    }
+    if (doc.name.contains(term)) {
+        return SCORE_NAME_CONTAINS;
+    }
+    if (doc.origin.contains(term)) {
+        return SCORE_ORIGIN_CONTAINS;
+    }
+    if (doc.description.contains(term)) {
+        return SCORE_DESCRIPTION_CONTAINS;
+    }
+    return 0;
+}
+
+/**
+ * @brief SearchIndex::candidatesFor
+ * @param term - lowercase term, at least TRIGRAM_LEN long
+ * @return sorted ids of documents containing all trigrams of term
+ */
+QVector<int> SearchIndex::candidatesFor(const QString &term) const
+{
+    QSet<quint64> trigrams;
+    collectTrigrams(term, trigrams);
+
+    QVector<const QVector<int> *> lists;
+    lists.reserve(trigrams.size());
+    for (const quint64 key : trigrams) {
+        const auto it = m_postings.constFind(key);
+        if (it == m_postings.constEnd()) {
+            return QVector<int>(); // no document has this trigram
+        }
+        lists.append(&it.value());
+    }
+
+    // intersect shortest lists first, it's cheaper
+    std::sort(lists.begin(), lists.end(),
+              [](const QVector<int> *a, const QVector<int> *b) {
+        return a->size() < b->size();
+    });
+
+    QVector<int> ret = *lists.first();
+    for (int i = 1; i < lists.size() && !ret.isEmpty(); i++) {
+        QVector<int> both;
+        std::set_intersection(ret.constBegin(), ret.constEnd(),
+                              lists.at(i)->constBegin(), lists.at(i)->constEnd(),
+                              std::back_inserter(both));
+        ret = both;
+    }
+    return ret;
+}
+
+} // namespace QtApk
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef H_QTAPK_SEARCH_INDEX
+#define H_QTAPK_SEARCH_INDEX
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+//  libapk forward decls
+struct apk_package;
+
+namespace QtApk {
+
+/**
+ * @brief The SearchIndex class
+ * Trigram inverted index over package names, origins and
+ * descriptions, used by Database::search().
+ *
+ * Packages are only ever added to the index: libapk does not
+ * free package records until database is closed, so to refresh
+ * the index only records that were not seen before have to be
+ * indexed. Index must be cleared when database is closed.
+ *
+ * Not thread-safe.
+ */
+class SearchIndex
+{
+public:
+    /**
+     * @brief clear
+     * Forget all indexed packages.
+     */
+    void clear();
+
+    /**
+     * @brief addPackages
+     * Index packages that are not indexed yet, skip all others.
+     * @param pkgs - packages to index
+     * @return number of newly indexed packages
+     */
+    int addPackages(const QVector<struct apk_package *> &pkgs);
+
+    /**
+     * @brief search
+     * Case-insensitive substring search. Query is split into
+     * whitespace-separated terms, each term must be found in
+     * package name, origin or description.
+     * @param query - search string
+     * @param limit - max number of results to return
+     * @return found packages, best matches first
+     */
+    QVector<struct apk_package *> search(const QString &query, int limit) const;
+
+    /**
+     * @brief size
+     * @return number of indexed packages
+     */
+    int size() const { return m_docs.size(); }
+
+private:
+    struct Document {
+        struct apk_package *pkg;
+        // all texts are stored in lower case
+        QString name;
+        QString origin;
+        QString description;
+    };
+
+    static void collectTrigrams(const QString &text, QSet<quint64> &out);
+    static int scoreTerm(const Document &doc, const QString &term);
+    QVector<int> candidatesFor(const QString &term) const;
+
+    QVector<Document> m_docs;                //! document id is an index in this vector
+    QHash<quint64, QVector<int>> m_postings; //! trigram => sorted document ids
+    QSet<struct apk_package *> m_indexed;    //! already indexed packages
+};
+
+} // namespace QtApk
+
+#endif
@@ -73,6 +73,14 @@ void TransactionPrivate::start()
 
 void TransactionPrivate::cancel()
 {
+    if (!_asyncObject || !q_ptr) {
+        return;
+    }
+    // executor removes transaction from its queue, or asks
+    //    running operation to stop; called directly, in this thread
+    QMetaObject::invokeMethod(_asyncObject, "cancelTransaction",
+                              Qt::DirectConnection,
+                              Q_ARG(void *, q_ptr));
 }
 
 TransactionUpdatePrivate::TransactionUpdatePrivate(QObject *callObject,
@@ -89,67 +97,72 @@ TransactionUpdatePrivate::TransactionUpdatePrivate(QObject *callObject,
 
 void TransactionUpdatePrivate::start()
 {
+    // only puts transaction into executor's queue,
+    //    so it is called directly, in this thread
     QMetaObject::invokeMethod(_asyncObject, _asyncMethodName.c_str(),
-                              Qt::QueuedConnection,
+                              Qt::DirectConnection,
                               Q_ARG(void *, q_ptr),
                               Q_ARG(DbUpdateFlags, _callFlags));
 }
 
-void TransactionUpdatePrivate::cancel()
-{
-    // we cannot cancel apk update operation (yet?)
-    // maybe to do later
-}
-
 TransactionAddPrivate::TransactionAddPrivate(QObject *callObject,
                                              const char *methodName,
-                                             const QString &pkgNameSpec)
+                                             const QStringList &pkgNameSpecs,
+                                             DbAddFlags flags)
     : TransactionPrivate(nullptr)
 {
     _typ = Transaction::TransactionType::ADD;
     _asyncObject = callObject;
     _asyncMethodName.assign(methodName);
-    _pkgNameSpec = pkgNameSpec;
-    setDesc(QStringLiteral("Install package: ") + _pkgNameSpec);
+    _pkgNameSpecs = pkgNameSpecs;
+    _flags = flags;
+    if (_pkgNameSpecs.size() == 1) {
+        setDesc(QStringLiteral("Install package: ") + _pkgNameSpecs.first());
+    } else {
+        setDesc(QStringLiteral("Install packages: ") + _pkgNameSpecs.join(QStringLiteral(", ")));
+    }
 }
 
 void TransactionAddPrivate::start()
 {
+    // only puts transaction into executor's queue,
+    //    so it is called directly, in this thread
     QMetaObject::invokeMethod(_asyncObject, _asyncMethodName.c_str(),
-                              Qt::QueuedConnection,
+                              Qt::DirectConnection,
                               Q_ARG(void *, q_ptr),
-                              Q_ARG(QString, _pkgNameSpec));
-}
-
-void TransactionAddPrivate::cancel()
-{
+                              Q_ARG(QStringList, _pkgNameSpecs),
+                              Q_ARG(DbAddFlags, _flags),
+                              Q_ARG(void *, &_changeset));
 }
 
 TransactionDelPrivate::TransactionDelPrivate(QObject *callObject,
                                              const char *methodName,
-                                             const QString &pkgNameSpec,
+                                             const QStringList &pkgNameSpecs,
                                              DbDelFlags flags)
     : TransactionPrivate(nullptr)
 {
     _typ = Transaction::TransactionType::DEL;
     _asyncObject = callObject;
     _asyncMethodName.assign(methodName);
-    _pkgNameSpec = pkgNameSpec;
+    _pkgNameSpecs = pkgNameSpecs;
     _flags = flags;
-    setDesc(QStringLiteral("Remove package: ") + _pkgNameSpec);
+    if (_pkgNameSpecs.size() == 1) {
+        setDesc(QStringLiteral("Remove package: ") + _pkgNameSpecs.first());
+    } else {
+        setDesc(QStringLiteral("Remove packages: ") + _pkgNameSpecs.join(QStringLiteral(", ")));
+    }
 }
 
 void TransactionDelPrivate::start()
 {
+    // only puts transaction into executor's queue,
+    //    so it is called directly, in this thread
     QMetaObject::invokeMethod(_asyncObject, _asyncMethodName.c_str(),
-                              Qt::QueuedConnection,
+                              Qt::DirectConnection,
                               Q_ARG(void *, q_ptr),
-                              Q_ARG(QString, _pkgNameSpec),
-                              Q_ARG(DbDelFlags, _flags));
-}
-
-void TransactionDelPrivate::cancel()
-{
+                              Q_ARG(QStringList, _pkgNameSpecs),
+                              Q_ARG(DbDelFlags, _flags),
+                              Q_ARG(void *, &_changeset));
 }
 
 TransactionUpgradePrivate::TransactionUpgradePrivate(QObject *callObject,
@@ -166,15 +179,13 @@ TransactionUpgradePrivate::TransactionUpgradePrivate(QObject *callObject,
 
 void TransactionUpgradePrivate::start()
 {
+    // only puts transaction into executor's queue,
+    //    so it is called directly, in this thread
     QMetaObject::invokeMethod(_asyncObject, _asyncMethodName.c_str(),
-                              Qt::QueuedConnection,
+                              Qt::DirectConnection,
                               Q_ARG(void *, q_ptr),
                               Q_ARG(DbUpgradeFlags, _flags),
                               Q_ARG(void *, &_changeset));
 }
 
-void TransactionUpgradePrivate::cancel()
-{
-}
-
 } // namespace QtApk
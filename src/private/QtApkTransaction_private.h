@@ -4,6 +4,7 @@
 #define H_QTAPK_TRANSACTION_PRIVATE
 
 #include <QString>
+#include <QStringList>
 #include <QVector>
 #include <QObject>
 #include <string>
@@ -42,7 +43,7 @@ public:
     DatabaseAsyncPrivate *_db = nullptr;
 
     // information needed to call invokeMethod:
-    QObject *_asyncObject;
+    QObject *_asyncObject = nullptr;
     std::string _asyncMethodName;
 };
 
@@ -52,7 +53,6 @@ class TransactionUpdatePrivate: public TransactionPrivate
 public:
     TransactionUpdatePrivate(QObject *callObject, const char *methodName, DbUpdateFlags flags);
     void start() override;
-    void cancel() override;
 
 private:
     DbUpdateFlags _callFlags;
@@ -62,24 +62,24 @@ private:
 class TransactionAddPrivate: public TransactionPrivate
 {
 public:
-    TransactionAddPrivate(QObject *callObject, const char *methodName, const QString &pkgNameSpec);
+    TransactionAddPrivate(QObject *callObject, const char *methodName,
+                          const QStringList &pkgNameSpecs, DbAddFlags flags);
     void start() override;
-    void cancel() override;
 
 private:
-    QString _pkgNameSpec;
+    QStringList _pkgNameSpecs;
+    DbAddFlags _flags;
 };
 
 
 class TransactionDelPrivate: public TransactionPrivate
 {
 public:
-    TransactionDelPrivate(QObject *callObject, const char *methodName, const QString &pkgNameSpec, DbDelFlags flags);
+    TransactionDelPrivate(QObject *callObject, const char *methodName, const QStringList &pkgNameSpecs, DbDelFlags flags);
     void start() override;
-    void cancel() override;
 
 private:
-    QString _pkgNameSpec;
+    QStringList _pkgNameSpecs;
     DbDelFlags _flags;
 };
 
@@ -89,7 +89,6 @@ class TransactionUpgradePrivate: public TransactionPrivate
 public:
     TransactionUpgradePrivate(QObject *callObject, const char *methodName, DbUpgradeFlags flags);
     void start() override;
-    void cancel() override;
 
 private:
     DbUpgradeFlags _flags;
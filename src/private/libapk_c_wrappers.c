@@ -1,6 +1,17 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "libapk_c_wrappers.h"
 
@@ -125,6 +136,11 @@ int w_db_check_world(struct apk_database *db)
     return apk_db_check_world(db, db->world);
 }
 
+int w_db_check_world_deps(struct apk_database *db, struct apk_dependency_array *world)
+{
+    return apk_db_check_world(db, world);
+}
+
 bool w_db_has_installed(const struct apk_database *db)
 {
     struct apk_installed_package *ipkg;
@@ -140,17 +156,22 @@ bool w_db_has_installed(const struct apk_database *db)
     return true;
 }
 
-void w_db_enumerate_installed(const struct apk_database *db, ENUMERATE_INSTALLED_CB cb, void *cb_param)
+int w_db_enumerate_installed(const struct apk_database *db, ENUMERATE_INSTALLED_CB cb, void *cb_param)
 {
     struct apk_installed_package *ipkg;
+    int r;
     ipkg = list_entry((&db->installed.packages)->next,
                       struct apk_installed_package,
                       installed_pkgs_list);
     while (&ipkg->installed_pkgs_list != &db->installed.packages) {
-        cb(ipkg->pkg, cb_param); // call callback
+        r = cb(ipkg->pkg, cb_param); // call callback
+        if (r != 0) {
+            return r; // callback requested to stop
+        }
         ipkg = list_entry(ipkg->installed_pkgs_list.next,
                           typeof(*ipkg), installed_pkgs_list);
     }
+    return 0;
 }
 
 int w_db_enumerate_available(struct apk_database *db, ENUMERATE_AVAILABLE_CB cb, void *cb_param)
@@ -158,11 +179,110 @@ int w_db_enumerate_available(struct apk_database *db, ENUMERATE_AVAILABLE_CB cb,
     return apk_hash_foreach(&db->available.packages, cb, cb_param);
 }
 
+int w_db_enumerate_upgradeable(struct apk_database *db, ENUMERATE_UPGRADEABLE_CB cb, void *cb_param)
+{
+    struct apk_installed_package *ipkg;
+    struct apk_provider *p;
+    int r;
+
+    list_for_each_entry(ipkg, &db->installed.packages, installed_pkgs_list) {
+        struct apk_package *pkg = ipkg->pkg;
+        struct apk_package *best = pkg;
+
+        if (!pkg->version) {
+            continue;
+        }
+        foreach_array_item(p, pkg->name->providers) {
+            struct apk_package *candidate = p->pkg;
+            // only real packages of the same name (not other providers),
+            //    that can be installed from some loaded repository
+            if (candidate->name != pkg->name || !candidate->version) {
+                continue;
+            }
+            if ((candidate->repos & db->available_repos) == 0) {
+                continue;
+            }
+            if (apk_version_compare_blob(*candidate->version, *best->version) == APK_VERSION_GREATER) {
+                best = candidate;
+            }
+        }
+        if (best != pkg) {
+            r = cb(pkg, best, cb_param);
+            if (r != 0) {
+                return r;
+            }
+        }
+    }
+    return 0;
+}
+
+// wraps apk_hash_foreach(&db->available.names, ...)
+int w_db_enumerate_names(struct apk_database *db, ENUMERATE_AVAILABLE_CB cb, void *cb_param)
+{
+    return apk_hash_foreach(&db->available.names, cb, cb_param);
+}
+
+// wraps apk_hash_get(&db->available.names, name)
+struct apk_name *w_db_get_name(struct apk_database *db, const char *name)
+{
+    const apk_blob_t name_blob = APK_BLOB_STR(name);
+    return (struct apk_name *)apk_hash_get(&db->available.names, name_blob);
+}
+
+// wraps name->name
+const char *w_apk_name_get_name(const struct apk_name *name)
+{
+    return name->name;
+}
+
+// wraps name->providers->num
+unsigned int w_apk_name_get_num_providers(const struct apk_name *name)
+{
+    return (unsigned int)name->providers->num;
+}
+
+// wraps name->providers->item[i].pkg
+struct apk_package *w_apk_name_get_provider(struct apk_name *name, unsigned int i)
+{
+    return name->providers->item[i].pkg;
+}
+
+// wraps apk_pkg_get_installed()
+struct apk_package *w_apk_name_get_installed(struct apk_name *name)
+{
+    return apk_pkg_get_installed(name);
+}
+
+// libfetch keeps its connection cache and last error (fetchLastErrCode/
+//    fetchLastErrString) in globals. Everything that may call it from this
+//    process holds this lock: repository fetch and changeset commit (which
+//    downloads packages missing from cache). Concurrent downloads of a fetch
+//    pool run in forked worker processes, each with its own copy of globals.
+static pthread_mutex_t w_internal_fetch_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int w_internal_cache_download(struct apk_database *db, struct apk_repository *repo,
+                                     struct apk_package *pkg, int verify, int autoupdate,
+                                     DOWNLOAD_PROGRESS_CB cb, void *cb_ctx)
+{
+    int r;
+
+    pthread_mutex_lock(&w_internal_fetch_mutex);
+    r = apk_cache_download(db, repo, pkg, verify, autoupdate, cb, cb_ctx);
+    pthread_mutex_unlock(&w_internal_fetch_mutex);
+    return r;
+}
+
+struct w_internal_fetch_progress {
+    size_t *bytes_fetched;
+    DOWNLOAD_PROGRESS_CB cb;
+    void *cb_ctx;
+};
+
 static void w_internal_repoupdate_progress_cb(void *cb_ctx, size_t p)
 {
-    (void)cb_ctx;
-    (void)p;
-    // useless, numbers are too unpredictable
+    // remember number of bytes read so far and pass them on;
+    //    total index size is not known, so as a percentage
+    //    it is useless, numbers are too unpredictable
     /*
      * OK: DB was opened!
      * qtapk: Updating: [ http://mirror.yandex.ru/mirrors/alpine/v3.11/main ] v3.11.3-31-g2e6d6d513d
@@ -186,36 +306,451 @@ static void w_internal_repoupdate_progress_cb(void *cb_ctx, size_t p)
      * qtapk: To install: 0 ; To remove: 0 ; To adjust: 18
      * 18  packages can be updated.
      * */
+    struct w_internal_fetch_progress *progress = (struct w_internal_fetch_progress *)cb_ctx;
+    if (progress->bytes_fetched) {
+        *progress->bytes_fetched = p;
+    }
+    if (progress->cb) {
+        progress->cb(progress->cb_ctx, p);
+    }
 }
 
 // return 0 on success
-int w_db_repository_update(struct apk_database *db, int iRepo, bool allow_untrusted)
+int w_db_repository_fetch(struct apk_database *db, int iRepo, bool allow_untrusted,
+                          size_t *bytes_fetched, DOWNLOAD_PROGRESS_CB cb, void *cb_ctx)
 {
     struct apk_repository *repo = &db->repos[iRepo];
+    struct w_internal_fetch_progress progress = { bytes_fetched, cb, cb_ctx };
 
-    int r = 0;
     int verify_flag = allow_untrusted ? APK_SIGN_NONE : APK_SIGN_VERIFY;
+    // skip index younger than db->cache_max_age, otherwise
+    //    fetch it only if modified since cached index mtime
     int autoupdate = 1;
 
-    r = apk_cache_download(db, repo, NULL, verify_flag, autoupdate,
-                           w_internal_repoupdate_progress_cb, (void *)NULL);
+    if (bytes_fetched) {
+        *bytes_fetched = 0;
+    }
+    return w_internal_cache_download(db, repo, NULL, verify_flag, autoupdate,
+                                     w_internal_repoupdate_progress_cb, (void *)&progress);
+}
+
+unsigned int w_db_get_cache_max_age(const struct apk_database *db)
+{
+    return db->cache_max_age;
+}
+
+void w_db_set_cache_max_age(struct apk_database *db, unsigned int secs)
+{
+    db->cache_max_age = secs;
+}
+
+struct w_internal_repo_counts {
+    unsigned int *counts;
+    unsigned int num_counts;
+};
+
+static int w_internal_count_repo_packages_cb(apk_hash_item item, void *ctx)
+{
+    struct w_internal_repo_counts *counts = (struct w_internal_repo_counts *)ctx;
+    const struct apk_package *pkg = (const struct apk_package *)item;
+    unsigned int iRepo;
+
+    for (iRepo = 0; iRepo < counts->num_counts; iRepo++) {
+        if (pkg->repos & BIT(iRepo)) {
+            counts->counts[iRepo]++;
+        }
+    }
+    return 0;
+}
+
+void w_db_count_packages_by_repo(struct apk_database *db, unsigned int *counts, unsigned int num_counts)
+{
+    struct w_internal_repo_counts ctx = { counts, num_counts };
+    unsigned int i;
+
+    for (i = 0; i < num_counts; i++) {
+        counts[i] = 0;
+    }
+    apk_hash_foreach(&db->available.packages, w_internal_count_repo_packages_cb, &ctx);
+}
+
+void w_db_repository_count_update(struct apk_database *db, int r)
+{
     if (r == -EALREADY) {
-        return 0;
+        return;
     }
     if (r != 0) {
         db->repo_update_errors++;
     } else {
         db->repo_update_counter++;
     }
+}
+
+int w_db_repository_update(struct apk_database *db, int iRepo, bool allow_untrusted)
+{
+    int r = w_db_repository_fetch(db, iRepo, allow_untrusted, NULL, NULL, NULL);
+    w_db_repository_count_update(db, r);
+    if (r == -EALREADY) {
+        return 0;
+    }
     return r;
 }
 
+bool w_db_cache_active(struct apk_database *db)
+{
+    return apk_db_cache_active(db) ? true : false;
+}
+
+void w_apk_package_set_cached(struct apk_package *pkg)
+{
+    pkg->repos |= BIT(APK_REPOSITORY_CACHED);
+}
+
+// one job of w_fetch_pool: repository index fetch or package download
+struct w_internal_fetch_job {
+    int iRepo;                // repository to fetch index of, if pkg is NULL
+    struct apk_package *pkg;  // package to download into cache
+    int verify;               // APK_SIGN_* flag
+    int state;                // W_INTERNAL_JOB_*
+    pid_t pid;                // worker process, while running
+    int fd;                   // read end of worker's pipe, while running
+    bool got_result;          // worker has sent its final message
+    int result;
+    size_t bytes;
+    struct timespec started;
+    long long wall_time_ms;
+};
+
+#define W_INTERNAL_JOB_QUEUED   0
+#define W_INTERNAL_JOB_RUNNING  1
+#define W_INTERNAL_JOB_DONE     2
+#define W_INTERNAL_JOB_REPORTED 3
+
+// message written by worker process into its pipe
+struct w_internal_fetch_msg {
+    int done;       // 0 - progress, 1 - final result
+    int result;
+    size_t bytes;
+};
+
+struct w_fetch_pool {
+    struct apk_database *db;
+    unsigned int max_parallel;
+    unsigned int num_running;
+    struct w_internal_fetch_job *jobs;
+    unsigned int num_jobs;
+    unsigned int cap_jobs;
+};
+
+static long long w_internal_elapsed_ms(const struct timespec *since)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)(now.tv_sec - since->tv_sec) * 1000
+            + (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+static void w_internal_write_msg(int fd, const struct w_internal_fetch_msg *msg)
+{
+    ssize_t r;
+
+    // message is smaller than PIPE_BUF, so write is atomic
+    do {
+        r = write(fd, msg, sizeof(*msg));
+    } while (r < 0 && errno == EINTR);
+}
+
+static void w_internal_worker_progress_cb(void *cb_ctx, size_t p)
+{
+    struct w_internal_fetch_msg msg = { 0, 0, p };
+
+    w_internal_write_msg(*(int *)cb_ctx, &msg);
+}
+
+// runs in worker process, never returns. Worker has only this
+//    one thread, so libfetch globals there are its own
+static void w_internal_fetch_worker(struct apk_database *db, struct w_internal_fetch_job *job, int fd)
+{
+    struct w_internal_fetch_msg msg = { 1, 0, 0 };
+    struct apk_repository *repo;
+
+    if (job->pkg) {
+        repo = apk_db_select_repo(db, job->pkg);
+        msg.result = repo ? apk_cache_download(db, repo, job->pkg, job->verify, 0,
+                                               w_internal_worker_progress_cb, &fd)
+                          : -ENOENT;
+        if (msg.result == -EALREADY) {
+            msg.result = 0;
+        }
+    } else {
+        // skip index younger than db->cache_max_age, otherwise
+        //    fetch it only if modified since cached index mtime
+        msg.result = apk_cache_download(db, &db->repos[job->iRepo], NULL, job->verify, 1,
+                                        w_internal_worker_progress_cb, &fd);
+    }
+    w_internal_write_msg(fd, &msg);
+    // no atexit handlers, no flushing of stdio buffers inherited from parent
+    _exit(0);
+}
+
+static void w_internal_fetch_job_finish(struct w_fetch_pool *pool, struct w_internal_fetch_job *job,
+                                        int result)
+{
+    int status;
+
+    if (job->state == W_INTERNAL_JOB_RUNNING) {
+        if (job->got_result) {
+            result = job->result; // finished already, only pipe was not closed yet
+        } else if (result == -ECANCELED) {
+            // unlike a thread, worker can be stopped in the middle of transfer
+            kill(job->pid, SIGKILL);
+        }
+        close(job->fd);
+        while (waitpid(job->pid, &status, 0) < 0 && errno == EINTR) {
+        }
+        pool->num_running--;
+        job->wall_time_ms = w_internal_elapsed_ms(&job->started);
+    }
+    job->result = result;
+    job->state = W_INTERNAL_JOB_DONE;
+}
+
+static void w_internal_fetch_job_start(struct w_fetch_pool *pool, struct w_internal_fetch_job *job)
+{
+    int fds[2];
+    pid_t pid;
+    int r;
+
+    if (pipe(fds) != 0) {
+        w_internal_fetch_job_finish(pool, job, -errno);
+        return;
+    }
+    pid = fork();
+    if (pid < 0) {
+        r = -errno;
+        close(fds[0]);
+        close(fds[1]);
+        w_internal_fetch_job_finish(pool, job, r);
+        return;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        w_internal_fetch_worker(pool->db, job, fds[1]);
+    }
+    close(fds[1]);
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    job->pid = pid;
+    job->fd = fds[0];
+    job->state = W_INTERNAL_JOB_RUNNING;
+    clock_gettime(CLOCK_MONOTONIC, &job->started);
+    pool->num_running++;
+}
+
+static void w_internal_fetch_pool_start_queued(struct w_fetch_pool *pool)
+{
+    unsigned int i;
+
+    for (i = 0; i < pool->num_jobs && pool->num_running < pool->max_parallel; i++) {
+        if (pool->jobs[i].state == W_INTERNAL_JOB_QUEUED) {
+            w_internal_fetch_job_start(pool, &pool->jobs[i]);
+        }
+    }
+}
+
+// reads one message from worker; finishes job when worker closes the pipe
+static void w_internal_fetch_job_read(struct w_fetch_pool *pool, unsigned int iJob,
+                                      FETCH_JOB_PROGRESS_CB progress_cb, void *cb_ctx)
+{
+    struct w_internal_fetch_job *job = &pool->jobs[iJob];
+    struct w_internal_fetch_msg msg;
+    ssize_t r;
+
+    do {
+        r = read(job->fd, &msg, sizeof(msg));
+    } while (r < 0 && errno == EINTR);
+    if (r == (ssize_t)sizeof(msg)) {
+        if (msg.done) {
+            job->got_result = true;
+            job->result = msg.result;
+        } else {
+            job->bytes = msg.bytes;
+            if (progress_cb) {
+                progress_cb(cb_ctx, (int)iJob, msg.bytes);
+            }
+        }
+        return;
+    }
+    // worker exited; without final message it has crashed
+    w_internal_fetch_job_finish(pool, job, job->got_result ? job->result : -EIO);
+}
+
+struct w_fetch_pool *w_fetch_pool_new(struct apk_database *db, unsigned int max_parallel)
+{
+    struct w_fetch_pool *pool = calloc(1, sizeof(struct w_fetch_pool));
+
+    if (pool) {
+        pool->db = db;
+        pool->max_parallel = max_parallel > 0 ? max_parallel : 1;
+    }
+    return pool;
+}
+
+static struct w_internal_fetch_job *w_internal_fetch_pool_add(struct w_fetch_pool *pool)
+{
+    struct w_internal_fetch_job *jobs;
+    unsigned int cap;
+
+    if (pool->num_jobs == pool->cap_jobs) {
+        cap = pool->cap_jobs ? pool->cap_jobs * 2 : 8;
+        jobs = realloc(pool->jobs, cap * sizeof(struct w_internal_fetch_job));
+        if (!jobs) {
+            return NULL;
+        }
+        pool->jobs = jobs;
+        pool->cap_jobs = cap;
+    }
+    jobs = &pool->jobs[pool->num_jobs++];
+    memset(jobs, 0, sizeof(*jobs));
+    jobs->iRepo = -1;
+    jobs->fd = -1;
+    jobs->state = W_INTERNAL_JOB_QUEUED;
+    return jobs;
+}
+
+int w_fetch_pool_add_repository(struct w_fetch_pool *pool, int iRepo, bool allow_untrusted)
+{
+    struct w_internal_fetch_job *job = w_internal_fetch_pool_add(pool);
+
+    if (!job) {
+        return -ENOMEM;
+    }
+    job->iRepo = iRepo;
+    job->verify = allow_untrusted ? APK_SIGN_NONE : APK_SIGN_VERIFY;
+    return (int)(pool->num_jobs - 1);
+}
+
+int w_fetch_pool_add_package(struct w_fetch_pool *pool, struct apk_package *pkg)
+{
+    struct w_internal_fetch_job *job = w_internal_fetch_pool_add(pool);
+
+    if (!job) {
+        return -ENOMEM;
+    }
+    job->pkg = pkg;
+    job->verify = APK_SIGN_VERIFY_IDENTITY;
+    if (pkg->repos & pool->db->local_repos) {
+        // nothing to download, no worker needed
+        w_internal_fetch_job_finish(pool, job, 0);
+    }
+    return (int)(pool->num_jobs - 1);
+}
+
+void w_fetch_pool_cancel(struct w_fetch_pool *pool)
+{
+    unsigned int i;
+
+    for (i = 0; i < pool->num_jobs; i++) {
+        if (pool->jobs[i].state == W_INTERNAL_JOB_QUEUED
+                || pool->jobs[i].state == W_INTERNAL_JOB_RUNNING) {
+            w_internal_fetch_job_finish(pool, &pool->jobs[i], -ECANCELED);
+        }
+    }
+}
+
+bool w_fetch_pool_wait(struct w_fetch_pool *pool, struct w_fetch_result *res,
+                       FETCH_JOB_PROGRESS_CB progress_cb, FETCH_CANCEL_CB cancel_cb, void *cb_ctx)
+{
+    struct pollfd *fds;
+    unsigned int *fdJobs;
+    unsigned int i, n;
+    bool ret = false;
+
+    fds = calloc(pool->max_parallel, sizeof(struct pollfd));
+    fdJobs = calloc(pool->max_parallel, sizeof(unsigned int));
+    if (!fds || !fdJobs) {
+        w_fetch_pool_cancel(pool);
+    }
+    for (;;) {
+        if (cancel_cb && cancel_cb(cb_ctx)) {
+            w_fetch_pool_cancel(pool);
+        }
+        w_internal_fetch_pool_start_queued(pool);
+        for (i = 0; i < pool->num_jobs; i++) {
+            struct w_internal_fetch_job *job = &pool->jobs[i];
+            if (job->state == W_INTERNAL_JOB_DONE) {
+                job->state = W_INTERNAL_JOB_REPORTED;
+                res->job = (int)i;
+                res->result = job->result;
+                res->bytes = job->bytes;
+                res->wall_time_ms = job->wall_time_ms;
+                ret = true;
+                goto out;
+            }
+        }
+        if (pool->num_running == 0) {
+            goto out; // everything was reported
+        }
+        n = 0;
+        for (i = 0; i < pool->num_jobs && n < pool->max_parallel; i++) {
+            if (pool->jobs[i].state == W_INTERNAL_JOB_RUNNING) {
+                fds[n].fd = pool->jobs[i].fd;
+                fds[n].events = POLLIN;
+                fds[n].revents = 0;
+                fdJobs[n] = i;
+                n++;
+            }
+        }
+        // wake up regularly to check for cancel
+        if (poll(fds, n, 100) <= 0) {
+            continue;
+        }
+        for (i = 0; i < n; i++) {
+            if (fds[i].revents) {
+                w_internal_fetch_job_read(pool, fdJobs[i], progress_cb, cb_ctx);
+            }
+        }
+    }
+out:
+    free(fds);
+    free(fdJobs);
+    return ret;
+}
+
+void w_fetch_pool_free(struct w_fetch_pool *pool)
+{
+    if (!pool) {
+        return;
+    }
+    w_fetch_pool_cancel(pool);
+    free(pool->jobs);
+    free(pool);
+}
+
 const char *w_db_get_repo_url(const struct apk_database *db, int iRepo)
 {
     const struct apk_repository *repo = &db->repos[iRepo];
     return repo->url;
 }
 
+time_t w_db_get_repo_index_mtime(struct apk_database *db, int iRepo)
+{
+    struct apk_repository *repo = &db->repos[iRepo];
+    struct stat st;
+    char buf[PATH_MAX];
+
+    if (db->cache_fd < 0) {
+        return 0;
+    }
+    if (apk_repo_format_cache_index(APK_BLOB_BUF(buf), repo) != 0) {
+        return 0;
+    }
+    if (fstatat(db->cache_fd, buf, &st, 0) != 0) {
+        return 0;
+    }
+    return st.st_mtime;
+}
+
 const char *w_db_get_repo_desc(const struct apk_database *db, int iRepo)
 {
     const struct apk_repository *repo = &db->repos[iRepo];
@@ -276,6 +811,19 @@ struct apk_package *w_apk_change_get_new_pkg(struct apk_change *c)
     return c->new_pkg;
 }
 
+bool w_apk_change_is_same_version(const struct apk_change *c)
+{
+    if (!c->old_pkg || !c->new_pkg) {
+        return false;
+    }
+    return c->old_pkg->version == c->new_pkg->version;
+}
+
+bool w_apk_package_needs_download(const struct apk_database *db, const struct apk_package *pkg)
+{
+    return (pkg->repos & db->local_repos) == 0;
+}
+
 const char *w_apk_package_get_pkg_name(const struct apk_package *pkg)
 {
     return pkg->name->name;
@@ -357,6 +905,31 @@ size_t w_apk_package_get_installedSize(const struct apk_package *pkg)
     return pkg->installed_size;
 }
 
+struct apk_name *w_apk_package_get_name(const struct apk_package *pkg)
+{
+    return pkg->name;
+}
+
+int w_apk_package_enumerate_deps(const struct apk_package *pkg, ENUMERATE_DEPS_CB cb, void *cb_param)
+{
+    struct apk_dependency *d;
+    int r;
+
+    foreach_array_item(d, pkg->depends) {
+        r = cb(pkg->name, d->name, d->conflict ? W_DEP_CONFLICTS : W_DEP_DEPENDS, cb_param);
+        if (r != 0) return r;
+    }
+    foreach_array_item(d, pkg->provides) {
+        r = cb(pkg->name, d->name, W_DEP_PROVIDES, cb_param);
+        if (r != 0) return r;
+    }
+    foreach_array_item(d, pkg->install_if) {
+        r = cb(pkg->name, d->name, W_DEP_INSTALL_IF, cb_param);
+        if (r != 0) return r;
+    }
+    return 0;
+}
+
 int w_apk_solver_solve(struct apk_database *db, unsigned short solver_flags, struct apk_changeset *cs)
 {
     return apk_solver_solve(db, solver_flags, db->world, cs);
@@ -364,7 +937,30 @@ int w_apk_solver_solve(struct apk_database *db, unsigned short solver_flags, str
 
 int w_apk_solver_commit_changeset(struct apk_database *db, struct apk_changeset *cs)
 {
-    return apk_solver_commit_changeset(db, cs, db->world);
+    return w_apk_solver_commit_changeset_world(db, cs, db->world);
+}
+
+void w_free_world(struct apk_dependency_array *world)
+{
+    apk_dependency_array_free(&world);
+}
+
+int w_apk_solver_solve_world(struct apk_database *db, unsigned short solver_flags,
+                             struct apk_dependency_array *world, struct apk_changeset *cs)
+{
+    return apk_solver_solve(db, solver_flags, world, cs);
+}
+
+int w_apk_solver_commit_changeset_world(struct apk_database *db, struct apk_changeset *cs,
+                                        struct apk_dependency_array *world)
+{
+    int r;
+
+    // commit fetches packages that are not in cache
+    pthread_mutex_lock(&w_internal_fetch_mutex);
+    r = apk_solver_commit_changeset(db, cs, world);
+    pthread_mutex_unlock(&w_internal_fetch_mutex);
+    return r;
 }
 
 static bool w_internal_non_repository_check(struct apk_database *db)
@@ -451,6 +1047,36 @@ int w_apk_add(struct apk_database *db,
     return r;
 }
 
+// returns 0 on success
+int w_apk_prepare_add_many(struct apk_database *db,
+                           const char *const *pkgNameSpecs,
+                           int num_specs,
+                           unsigned short solver_flags,
+                           struct apk_dependency_array **world_out,
+                           int *failed_index)
+{
+    struct apk_dependency_array *world_copy = NULL;
+    struct apk_dependency dep;
+    int i;
+
+    *world_out = NULL;
+    if (failed_index) *failed_index = -1;
+
+    // parse everything first, nothing is committed if any spec is bad
+    apk_dependency_array_copy(&world_copy, db->world);
+    for (i = 0; i < num_specs; i++) {
+        if (!w_internal_package_name_to_apk_dependency(db, pkgNameSpecs[i], &dep)) {
+            if (failed_index) *failed_index = i;
+            apk_dependency_array_free(&world_copy);
+            return 1;
+        }
+        apk_deps_add(&world_copy, &dep);
+        apk_solver_set_name_flags(dep.name, solver_flags, solver_flags);
+    }
+    *world_out = world_copy;
+    return 0;
+}
+
 /**
  * Internal struct passed as void* context in delete
  * package callbacks
@@ -490,54 +1116,55 @@ static void w_internal_cb_delete_pkg(struct apk_package *pkg0,
 }
 
 // returns 0 on success
-int w_apk_del(struct apk_database *db,
-              const char *pkgname,
-              bool recursive_delete)
+int w_apk_prepare_del_many(struct apk_database *db,
+                           const char *const *pkgnames,
+                           int num_names,
+                           bool recursive_delete,
+                           struct apk_dependency_array **world_out,
+                           int *failed_index)
 {
-    const apk_blob_t pkgname_blob = APK_BLOB_STR(pkgname);
-    struct apk_dependency_array *world_copy = NULL;
-    struct apk_changeset changeset = {};
     struct apk_name *name = NULL;
     struct apk_package *pkg = NULL;
+    int i;
 
-    apk_dependency_array_copy(&world_copy, db->world);
+    *world_out = NULL;
+    if (failed_index) *failed_index = -1;
 
     // fill in deletion context
     struct w_internal_del_ctx dctx = {
         .recursive_delete = recursive_delete ? 1 : 0,
-        .world = world_copy,
+        .world = NULL,
         .errors = 0
     };
+    // world copy may be reallocated by apk_deps_del(),
+    //    so always refer to it as dctx.world
+    apk_dependency_array_copy(&dctx.world, db->world);
 
-    // find package name as apk_name in installed packages
-    name = (struct apk_name *)apk_hash_get(&db->available.names, pkgname_blob);
+    for (i = 0; i < num_names; i++) {
+        const apk_blob_t pkgname_blob = APK_BLOB_STR(pkgnames[i]);
 
-    if (!name) {
-        dctx.errors++;
-        return 1;
-    }
+        // find package name as apk_name in installed packages
+        name = (struct apk_name *)apk_hash_get(&db->available.names, pkgname_blob);
 
-    // This time find package (not only name!)
-    // This function finds first provider of the name
-    //      that is actually installed
-    pkg = apk_pkg_get_installed(name);
-    if (pkg != NULL) {
-        // cb_delete_pkg() can call itself recursively to
-        //  delete reverse depends, if requested
-        w_internal_cb_delete_pkg(pkg, NULL, NULL, &dctx);
-    } else {
-        apk_deps_del(&dctx.world, name);
-    }
+        if (!name) {
+            dctx.errors++;
+            if (failed_index) *failed_index = i;
+            apk_dependency_array_free(&dctx.world);
+            return 1;
+        }
 
-    // solve world
-    int r = apk_solver_solve(db, 0, world_copy, &changeset);
-    if (r == 0) {
-        r = apk_solver_commit_changeset(db, &changeset, world_copy);
+        // This time find package (not only name!)
+        // This function finds first provider of the name
+        //      that is actually installed
+        pkg = apk_pkg_get_installed(name);
+        if (pkg != NULL) {
+            // cb_delete_pkg() can call itself recursively to
+            //  delete reverse depends, if requested
+            w_internal_cb_delete_pkg(pkg, NULL, NULL, &dctx);
+        } else {
+            apk_deps_del(&dctx.world, name);
+        }
     }
-
-    // cleanup
-    apk_change_array_free(&changeset.changes);
-    apk_dependency_array_free(&world_copy);
-    return r;
+    *world_out = dctx.world;
+    return 0;
 }
-
@@ -54,6 +54,7 @@ struct apk_repository;
 struct apk_dependency_array;
 struct apk_changeset;
 struct apk_package;
+struct apk_name;
 
 struct w_apk_database; // forward-decl
 
@@ -79,18 +80,116 @@ unsigned int w_db_get_repo_update_errors(const struct apk_database *db);
 int w_db_get_get_available_packages_count(const struct apk_database *db);
 // wraps apk_db_check_world()
 int w_db_check_world(struct apk_database *db);
+// same, for a given world copy
+int w_db_check_world_deps(struct apk_database *db, struct apk_dependency_array *world);
 
 bool w_db_has_installed(const struct apk_database *db);
 
-typedef void (*ENUMERATE_INSTALLED_CB)(struct apk_package *, void *);
+// enumeration callbacks: returning non-zero stops the enumeration
+typedef int (*ENUMERATE_INSTALLED_CB)(struct apk_package *, void *);
 typedef int (*ENUMERATE_AVAILABLE_CB)(void *, void *);
-void w_db_enumerate_installed(const struct apk_database *db, ENUMERATE_INSTALLED_CB cb, void *cb_param);
+// both return 0 if all packages were enumerated, or whatever
+//    non-zero value callback returned to stop enumeration
+int w_db_enumerate_installed(const struct apk_database *db, ENUMERATE_INSTALLED_CB cb, void *cb_param);
 int w_db_enumerate_available(struct apk_database *db, ENUMERATE_AVAILABLE_CB cb, void *cb_param);
 
+// callback receives installed package and a newer available package
+typedef int (*ENUMERATE_UPGRADEABLE_CB)(struct apk_package *, struct apk_package *, void *);
+// for each installed package finds the best available package with
+//    the same name using apk_version_compare_blob(), without running
+//    solver (so pinning and world constraints are not considered)
+// returns 0, or non-zero value returned by callback to stop enumeration
+int w_db_enumerate_upgradeable(struct apk_database *db, ENUMERATE_UPGRADEABLE_CB cb, void *cb_param);
+
+// wraps apk_hash_foreach(&db->available.names, ...),
+//    callback receives struct apk_name* as first argument
+int w_db_enumerate_names(struct apk_database *db, ENUMERATE_AVAILABLE_CB cb, void *cb_param);
+// wraps apk_hash_get(&db->available.names, name)
+// returns NULL if database does not know such name
+struct apk_name *w_db_get_name(struct apk_database *db, const char *name);
+// wraps name->name
+const char *w_apk_name_get_name(const struct apk_name *name);
+// wraps name->providers->num
+unsigned int w_apk_name_get_num_providers(const struct apk_name *name);
+// wraps name->providers->item[i].pkg
+struct apk_package *w_apk_name_get_provider(struct apk_name *name, unsigned int i);
+// wraps apk_pkg_get_installed(), returns NULL if name is not installed
+struct apk_package *w_apk_name_get_installed(struct apk_name *name);
+
+// download progress callback: (cb_ctx, bytes downloaded so far);
+//    may be called from the downloading thread
+typedef void (*DOWNLOAD_PROGRESS_CB)(void *, size_t);
+
+// wraps apk_db_cache_active()
+bool w_db_cache_active(struct apk_database *db);
+// marks package as available from cache: pkg->repos |= BIT(APK_REPOSITORY_CACHED)
+void w_apk_package_set_cached(struct apk_package *pkg);
+
+// Pool of downloads into cache that run in parallel, each one in its own
+//    forked worker process: libfetch keeps its state in globals and cannot
+//    be used from several threads, but separate processes do not share it.
+//    Workers write into the shared cache dir, database records are not
+//    touched; only the caller's thread uses the pool.
+struct w_fetch_pool;
+// result of one finished job
+struct w_fetch_result {
+    int job;                  // job index returned by w_fetch_pool_add_*()
+    int result;               // 0 on success, -EALREADY if cached index is fresh
+                              //    enough, -ECANCELED if cancelled, or error
+    size_t bytes;             // bytes downloaded
+    long long wall_time_ms;   // time the worker was running
+};
+// progress callback: (cb_ctx, job index, bytes downloaded so far)
+typedef void (*FETCH_JOB_PROGRESS_CB)(void *, int, size_t);
+// cancel callback: (cb_ctx), returns true to stop all jobs
+typedef bool (*FETCH_CANCEL_CB)(void *);
+// at most max_parallel workers run at once
+struct w_fetch_pool *w_fetch_pool_new(struct apk_database *db, unsigned int max_parallel);
+// queues fetch of repository index, same as w_db_repository_fetch();
+//    returns job index or negative error
+int w_fetch_pool_add_repository(struct w_fetch_pool *pool, int iRepo, bool allow_untrusted);
+// queues package download into cache: apk_db_select_repo() +
+//    apk_cache_download(), with package checksum verification; finishes
+//    at once if package is available from a local repository. Package
+//    record is not modified, call w_apk_package_set_cached() after success.
+//    returns job index or negative error
+int w_fetch_pool_add_package(struct w_fetch_pool *pool, struct apk_package *pkg);
+// starts queued jobs and waits until the next one finishes; callbacks are
+//    called from this function only. Cancel kills running workers, so even
+//    a transfer in progress stops, their and queued jobs finish with -ECANCELED.
+// returns false when results of all jobs were returned
+bool w_fetch_pool_wait(struct w_fetch_pool *pool, struct w_fetch_result *res,
+                       FETCH_JOB_PROGRESS_CB progress_cb, FETCH_CANCEL_CB cancel_cb, void *cb_ctx);
+// stops all running and queued jobs, see w_fetch_pool_wait()
+void w_fetch_pool_cancel(struct w_fetch_pool *pool);
+// stops what is still running and frees the pool
+void w_fetch_pool_free(struct w_fetch_pool *pool);
+
 // apk_repository_update() // is not public?? why, libapk??
 // return 0 on success
 int w_db_repository_update(struct apk_database *db, int iRepo, bool allow_untrusted);
+// same download as w_db_repository_update(), but does not touch database
+//    update counters, call w_db_repository_count_update() with the result.
+//    Runs under the same lock as changeset commits, libfetch is not reentrant
+// bytes_fetched - optional output, number of bytes downloaded
+// cb - optional, called with number of bytes downloaded so far
+// returns 0 on success, -EALREADY if cached index is fresh enough
+int w_db_repository_fetch(struct apk_database *db, int iRepo, bool allow_untrusted,
+                          size_t *bytes_fetched, DOWNLOAD_PROGRESS_CB cb, void *cb_ctx);
+// wraps db->cache_max_age: repository indexes younger than that (in seconds)
+//    are not fetched again by w_db_repository_fetch()
+unsigned int w_db_get_cache_max_age(const struct apk_database *db);
+void w_db_set_cache_max_age(struct apk_database *db, unsigned int secs);
+// counts available packages by repository in one pass:
+//    counts[iRepo] = number of packages available from repository iRepo
+void w_db_count_packages_by_repo(struct apk_database *db, unsigned int *counts, unsigned int num_counts);
+// adds w_db_repository_fetch() result r to db->repo_update_counter
+//    or db->repo_update_errors
+void w_db_repository_count_update(struct apk_database *db, int r);
 const char *w_db_get_repo_url(const struct apk_database *db, int iRepo);
+// returns modification time of repository index file in the cache dir
+//    (formatted by apk_repo_format_cache_index()), or 0 if there is no such file
+time_t w_db_get_repo_index_mtime(struct apk_database *db, int iRepo);
 const char *w_db_get_repo_desc(const struct apk_database *db, int iRepo);
 
 
@@ -111,6 +210,12 @@ struct apk_change *w_apk_changeset_get_change(struct apk_changeset *cs, int iCha
 bool w_apk_change_is_reinstall(const struct apk_change *c);
 struct apk_package *w_apk_change_get_old_pkg(struct apk_change *c);
 struct apk_package *w_apk_change_get_new_pkg(struct apk_change *c);
+// true if change has both old and new package with the same version;
+//    versions are atoms, so they are compared by pointer
+bool w_apk_change_is_same_version(const struct apk_change *c);
+// true if package is not available from any local repository
+//    (including cache), so it has to be downloaded to be installed
+bool w_apk_package_needs_download(const struct apk_database *db, const struct apk_package *pkg);
 
 const char *w_apk_package_get_pkg_name(const struct apk_package *pkg);
 const char *w_apk_package_get_version(const struct apk_package *pkg);
@@ -125,13 +230,38 @@ const char *w_apk_package_get_filename(const struct apk_package *pkg);
 time_t w_apk_package_get_buildTime(const struct apk_package *pkg);
 size_t w_apk_package_get_size(const struct apk_package *pkg);
 size_t w_apk_package_get_installedSize(const struct apk_package *pkg);
+// wraps pkg->name
+struct apk_name *w_apk_package_get_name(const struct apk_package *pkg);
+
+// kinds of edges reported by w_apk_package_enumerate_deps()
+enum w_dep_kind {
+    W_DEP_DEPENDS = 0,
+    W_DEP_PROVIDES = 1,
+    W_DEP_INSTALL_IF = 2,
+    W_DEP_CONFLICTS = 3
+};
+// callback receives: package name, name of the dependency, enum w_dep_kind
+typedef int (*ENUMERATE_DEPS_CB)(struct apk_name *, struct apk_name *, int, void *);
+// walks pkg->depends, pkg->provides and pkg->install_if arrays,
+//    depends with conflict bit set ("!name") are reported as W_DEP_CONFLICTS
+// returns 0, or non-zero value returned by callback to stop enumeration
+int w_apk_package_enumerate_deps(const struct apk_package *pkg, ENUMERATE_DEPS_CB cb, void *cb_param);
 
 
 // wraps apk_solver_solve
 int w_apk_solver_solve(struct apk_database *db, unsigned short solver_flags, struct apk_changeset *cs);
-// wraps apk_solver_commit_changeset
+// wraps apk_solver_commit_changeset; commits download packages missing
+//    from cache with libfetch, so they hold the lock of w_db_repository_fetch()
 int w_apk_solver_commit_changeset(struct apk_database *db, struct apk_changeset *cs);
 
+// frees a world copy made by w_apk_prepare_add_many() or w_apk_prepare_del_many()
+void w_free_world(struct apk_dependency_array *world);
+// same as above, but for a given world instead of db->world
+int w_apk_solver_solve_world(struct apk_database *db, unsigned short solver_flags,
+                             struct apk_dependency_array *world, struct apk_changeset *cs);
+int w_apk_solver_commit_changeset_world(struct apk_database *db, struct apk_changeset *cs,
+                                        struct apk_dependency_array *world);
+
 // more generic high level wrappers
 
 struct w_resolved_apk_dependency
@@ -148,10 +278,27 @@ int w_apk_add(struct apk_database *db,
               unsigned short solver_flags,
               struct w_resolved_apk_dependency *resolved_dep);
 
-// returns 0 on success
-int w_apk_del(struct apk_database *db,
-              const char *pkgname,
-              bool recursive_delete);
+// only creates a world copy with all specs added, without solving;
+//    on success *world_out must be freed by w_free_world()
+// returns 0 on success; if a spec cannot be parsed, returns non-zero
+//    and sets *failed_index (if not NULL) to its index, or -1 otherwise
+int w_apk_prepare_add_many(struct apk_database *db,
+                           const char *const *pkgNameSpecs,
+                           int num_specs,
+                           unsigned short solver_flags,
+                           struct apk_dependency_array **world_out,
+                           int *failed_index);
+
+// only creates a world copy with all names removed, without solving;
+//    on success *world_out must be freed by w_free_world()
+// returns 0 on success; if a name is unknown, returns non-zero
+//    and sets *failed_index (if not NULL) to its index, or -1 otherwise
+int w_apk_prepare_del_many(struct apk_database *db,
+                           const char *const *pkgnames,
+                           int num_names,
+                           bool recursive_delete,
+                           struct apk_dependency_array **world_out,
+                           int *failed_index);
 
 #ifdef __cplusplus
 } // extern "C"
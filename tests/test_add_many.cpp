@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDebug>
+
+#include <QtApk>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int ret = 0;
+    QtApk::Database db;
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READWRITE)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+    qDebug() << "OK: DB was opened!";
+
+    // invalid spec must be rejected before anything is committed
+    const QStringList badSpecs = {
+        QStringLiteral("fish"), QStringLiteral("this is not a valid spec")
+    };
+    if (db.add(badSpecs)) {
+        qWarning() << "FAIL: add() with invalid spec must fail";
+        ret = 1;
+    }
+
+    // empty lists are a no-op
+    if (!db.add(QStringList()) || !db.del(QStringList())) {
+        qWarning() << "FAIL: empty list must succeed";
+        ret = 1;
+    }
+
+    const QStringList pkgNames = { QStringLiteral("fish"), QStringLiteral("htop") };
+    if (!db.add(pkgNames)) {
+        qWarning() << "Failed to install packages" << pkgNames;
+        // not an error, fails in minimal chroot without
+        // repositories, but works in a full Alpine system
+    } else if (!db.del(pkgNames)) {
+        qWarning() << "Failed to delete packages" << pkgNames;
+    }
+
+    db.close();
+    return ret;
+}
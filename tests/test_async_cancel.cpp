@@ -0,0 +1,172 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+#include <QtApk>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    QtApk::DatabaseAsync db;
+
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READWRITE | QtApk::QTAPK_OPENF_ENABLE_PROGRESSFD)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+
+    // just to be safe, exit in any case in 180 seconds
+    QTimer::singleShot(180000, &app, []() {
+        qDebug() << "Quitting by timer!";
+        QCoreApplication::exit(100);
+    });
+
+    // forced update keeps executor busy, add behind it is still
+    //    queued when cancelled, update after it must run anyway;
+    //    last two updates are merged, cancelling one of them while
+    //    they run must not cancel the other
+    const QtApk::DbUpdateFlags updateFlags = static_cast<QtApk::DbUpdateFlags>(
+                QtApk::QTAPK_UPDATE_ALLOW_UNTRUSTED | QtApk::QTAPK_UPDATE_FORCE);
+    QVector<QtApk::Transaction *> transactions = {
+        db.updatePackageIndex(updateFlags),
+        db.add(QStringList(QStringLiteral("fish")), QtApk::QTAPK_ADD_SIMULATE),
+        db.updatePackageIndex(QtApk::QTAPK_UPDATE_ALLOW_UNTRUSTED),
+        db.updatePackageIndex(QtApk::QTAPK_UPDATE_ALLOW_UNTRUSTED),
+    };
+    for (QtApk::Transaction *tr : transactions) {
+        if (!tr) {
+            qWarning() << "FAIL: transaction was not created";
+            return 1;
+        }
+    }
+
+    int mainret = 0;
+    const int numTransactions = transactions.size();
+    QVector<int> numFinished(numTransactions, 0);
+    QVector<bool> wasCancelled(numTransactions, false);
+    int totalFinished = 0;
+    for (int i = 0; i < numTransactions; i++) {
+        QtApk::Transaction *tr = transactions.at(i);
+        QObject::connect(tr, &QtApk::Transaction::errorOccured, [tr, i, &mainret](QString msg) {
+            if (i == 1) {
+                qWarning() << "FAIL: cancelled transaction reported error:" << msg;
+                mainret = 1;
+            } else {
+                // not an error here, may fail without network access
+                qWarning() << "transaction" << tr->desc() << "failed:" << msg;
+            }
+        });
+        QObject::connect(tr, &QtApk::Transaction::cancelled, [i, &numFinished, &wasCancelled, &mainret]() {
+            if (numFinished.at(i) != 0) {
+                qWarning() << "FAIL: transaction" << i << "cancelled after it finished";
+                mainret = 1;
+            }
+            wasCancelled[i] = true;
+        });
+        QObject::connect(tr, &QtApk::Transaction::finished,
+                         [tr, i, numTransactions, &numFinished, &totalFinished]() {
+            qDebug() << "transaction" << i << "complete:" << tr->desc();
+            numFinished[i]++;
+            totalFinished++;
+            tr->deleteLater();
+            if (totalFinished == numTransactions) {
+                QTimer::singleShot(1000, QCoreApplication::instance(), &QCoreApplication::quit);
+            }
+        });
+    }
+    QtApk::Transaction *mergedTr = transactions.at(3);
+    bool mergedCancelRequested = false;
+    QObject::connect(mergedTr, &QtApk::Transaction::progressChanged,
+                     [mergedTr, &mergedCancelRequested](float) {
+        if (!mergedCancelRequested) {
+            mergedCancelRequested = true;
+            mergedTr->cancel();
+        }
+    });
+    for (QtApk::Transaction *tr : transactions) {
+        tr->start();
+    }
+    transactions.at(1)->cancel();
+
+    const int loopret = app.exec();
+    qDebug() << "mainloop exited with code:" << loopret;
+    if (loopret != 0) {
+        mainret = loopret;
+    }
+
+    for (int i = 0; i < numTransactions; i++) {
+        if (numFinished.at(i) != 1) {
+            qWarning() << "FAIL: transaction" << i << "finished" << numFinished.at(i) << "times";
+            mainret = 1;
+        }
+    }
+    if (!wasCancelled.at(1)) {
+        // only possible if executor got to it before cancel() call
+        qDebug() << "add was already running when cancelled, it completed";
+    }
+    if (wasCancelled.at(2)) {
+        qWarning() << "FAIL: transaction queued after cancelled one was cancelled too";
+        mainret = 1;
+    }
+    if (mergedCancelRequested && !wasCancelled.at(3)) {
+        qWarning() << "FAIL: merged update cancelled while running did not report cancelled()";
+        mainret = 1;
+    }
+
+    db.close();
+
+    // transactions still queued when database is closed must be
+    //    told they will never run
+    if (!db.open(QtApk::QTAPK_OPENF_READWRITE | QtApk::QTAPK_OPENF_ENABLE_PROGRESSFD)) {
+        qWarning() << "Failed to reopen APK DB!";
+        return 1;
+    }
+    QtApk::Transaction *busyTr = db.updatePackageIndex(updateFlags);
+    QtApk::Transaction *queuedTr = db.add(QStringList(QStringLiteral("fish")), QtApk::QTAPK_ADD_SIMULATE);
+    if (!busyTr || !queuedTr) {
+        qWarning() << "FAIL: transaction was not created";
+        return 1;
+    }
+    bool queuedCancelled = false;
+    bool queuedFinished = false;
+    QObject::connect(queuedTr, &QtApk::Transaction::cancelled, [&queuedCancelled]() {
+        queuedCancelled = true;
+    });
+    QObject::connect(queuedTr, &QtApk::Transaction::finished, [&queuedFinished]() {
+        queuedFinished = true;
+    });
+    busyTr->start();
+    queuedTr->start();
+    db.close();
+    QCoreApplication::processEvents();
+    if (queuedFinished && !queuedCancelled) {
+        // only possible if executor got to it before close()
+        qDebug() << "add was already running when database was closed, it completed";
+    } else if (!queuedCancelled || !queuedFinished) {
+        qWarning() << "FAIL: queued transaction got no cancelled()+finished() on close()";
+        mainret = 1;
+    }
+    delete busyTr;
+    delete queuedTr;
+
+    return mainret;
+}
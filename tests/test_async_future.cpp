@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFuture>
+
+#include <QtApk>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int ret = 0;
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    QtApk::DatabaseAsync db;
+
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READONLY)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+
+    // start all queries at once, then wait for them
+    QFuture<QVector<QtApk::Package>> installedFuture = db.getInstalledPackagesAsync();
+    QFuture<QVector<QtApk::Package>> availableFuture = db.getAvailablePackagesAsync(
+                QtApk::QTAPK_FIELD_NAME | QtApk::QTAPK_FIELD_VERSION);
+    QFuture<int> countFuture = db.upgradeablePackagesCountAsync();
+    QFuture<QVector<QtApk::Package>> searchFuture = db.searchAsync(
+                QStringLiteral("fish"), 50, QtApk::QTAPK_FIELD_NAME | QtApk::QTAPK_FIELD_DESCRIPTION);
+
+    const QVector<QtApk::Package> installed = installedFuture.result();
+    const QVector<QtApk::Package> available = availableFuture.result();
+    const int count = countFuture.result();
+    const QVector<QtApk::Package> found = searchFuture.result();
+    qDebug() << "Installed:" << installed.size() << "; available:" << available.size()
+             << "; upgradeable:" << count << "; found:" << found.size();
+
+    if (installed.size() != db.getInstalledPackages().size()) {
+        qWarning() << "FAIL: async installed packages differ from sync ones";
+        ret = 1;
+    }
+    if (available.size() != db.getAvailablePackages(QtApk::QTAPK_FIELD_NAME).size()) {
+        qWarning() << "FAIL: async available packages differ from sync ones";
+        ret = 1;
+    }
+    if (count != db.upgradeablePackagesCount()) {
+        qWarning() << "FAIL: async upgradeable count differs from sync one";
+        ret = 1;
+    }
+    const QVector<QtApk::Package> foundSync = db.search(QStringLiteral("fish"));
+    if (found.size() != foundSync.size()) {
+        qWarning() << "FAIL: async search differs from sync one";
+        ret = 1;
+    }
+    for (int i = 0; i < found.size() && i < foundSync.size(); i++) {
+        if (found.at(i).name != foundSync.at(i).name) {
+            qWarning() << "FAIL: async search result order differs from sync one";
+            ret = 1;
+            break;
+        }
+        // only requested fields are converted
+        if (found.at(i).name.isEmpty() || !found.at(i).version.isEmpty()) {
+            qWarning() << "FAIL: async search result fields differ from requested ones";
+            ret = 1;
+            break;
+        }
+    }
+
+    db.close();
+    return ret;
+}
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+#include <QtApk>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    QtApk::DatabaseAsync db;
+
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READWRITE | QtApk::QTAPK_OPENF_ENABLE_PROGRESSFD)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+
+    // just to be safe, exit in any case in 180 seconds
+    QTimer::singleShot(180000, &app, []() {
+        qDebug() << "Quitting by timer!";
+        QCoreApplication::exit(100);
+    });
+
+    // update, then install and remove a package: progress comes
+    //    from our own steps and from libapk's commit
+    QVector<QtApk::Transaction *> transactions = {
+        db.updatePackageIndex(QtApk::QTAPK_UPDATE_ALLOW_UNTRUSTED),
+        db.add(QStringLiteral("fish")),
+        db.del(QStringLiteral("fish")),
+    };
+
+    int mainret = 0;
+    int numFinished = 0;
+    int numSignals = 0;
+    QElapsedTimer sinceLast;
+    for (QtApk::Transaction *tr : transactions) {
+        if (!tr) {
+            qWarning() << "FAIL: transaction was not created";
+            return 1;
+        }
+        QObject::connect(tr, &QtApk::Transaction::errorOccured, [tr](QString msg) {
+            // not an error here, may fail without network access
+            qWarning() << "transaction" << tr->desc() << "failed:" << msg;
+        });
+        QObject::connect(tr, &QtApk::Transaction::progressChanged,
+                         [&sinceLast, &numSignals, &mainret](float percent) {
+            if (percent < 0.0f || percent > 100.0f) {
+                qWarning() << "FAIL: progress out of range:" << percent;
+                mainret = 1;
+            }
+            // signals are rate-limited; allow for timer inaccuracy
+            if (sinceLast.isValid() && sinceLast.elapsed() < 40) {
+                qWarning() << "FAIL: progress signals too close:" << sinceLast.elapsed() << "ms";
+                mainret = 1;
+            }
+            sinceLast.start();
+            numSignals++;
+        });
+        QObject::connect(tr, &QtApk::Transaction::finished,
+                         [tr, &numFinished, &transactions]() {
+            tr->deleteLater();
+            numFinished++;
+            if (numFinished == transactions.size()) {
+                QTimer::singleShot(1000, QCoreApplication::instance(), &QCoreApplication::quit);
+            }
+        });
+    }
+    for (QtApk::Transaction *tr : transactions) {
+        tr->start();
+    }
+
+    const int loopret = app.exec();
+    qDebug() << "mainloop exited with code:" << loopret << "; progress signals:" << numSignals;
+    if (loopret != 0) {
+        mainret = loopret;
+    }
+
+    db.close();
+    return mainret;
+}
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+#include <QtApk>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    QtApk::DatabaseAsync db;
+
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READWRITE | QtApk::QTAPK_OPENF_ENABLE_PROGRESSFD)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+
+    // just to be safe, exit in any case in 180 seconds
+    QTimer::singleShot(180000, &app, []() {
+        qDebug() << "Quitting by timer!";
+        QCoreApplication::exit(100);
+    });
+
+    // a burst of transactions, all started at once:
+    //    2 updates are collapsed into one, 3 adds and 2 dels are
+    //    merged into one solve and commit each; merged add fails
+    //    and is executed again one by one, so bad spec must only
+    //    fail its own add
+    const int iUpdate = 0;
+    const int iAddGood = 2;
+    const int iAddBad = 3;
+    QVector<QtApk::Transaction *> transactions = {
+        db.updatePackageIndex(QtApk::QTAPK_UPDATE_ALLOW_UNTRUSTED),
+        db.updatePackageIndex(QtApk::QTAPK_UPDATE_ALLOW_UNTRUSTED),
+        db.add(QStringLiteral("fish")),
+        db.add(QStringLiteral("no-such-package-qtapk")),
+        db.add(QStringLiteral("htop")),
+        db.del(QStringLiteral("fish")),
+        db.del(QStringLiteral("htop")),
+    };
+    for (QtApk::Transaction *tr : transactions) {
+        if (!tr) {
+            qWarning() << "FAIL: transaction was not created, queue must accept all of them";
+            return 1;
+        }
+    }
+
+    QVector<int> finishOrder;
+    QVector<int> failed;
+    const int numTransactions = transactions.size();
+    for (int i = 0; i < numTransactions; i++) {
+        QtApk::Transaction *tr = transactions.at(i);
+        QObject::connect(tr, &QtApk::Transaction::errorOccured, [tr, i, &failed](QString msg) {
+            // not an error here, may fail without network access
+            qWarning() << "transaction" << tr->desc() << "failed:" << msg;
+            failed.append(i);
+        });
+        QObject::connect(tr, &QtApk::Transaction::finished, [tr, i, numTransactions, &finishOrder]() {
+            qDebug() << "transaction" << i << "complete:" << tr->desc();
+            finishOrder.append(i);
+            tr->deleteLater();
+            if (finishOrder.size() == numTransactions) {
+                QTimer::singleShot(1000, QCoreApplication::instance(), &QCoreApplication::quit);
+            }
+        });
+    }
+    for (QtApk::Transaction *tr : transactions) {
+        tr->start();
+    }
+
+    int mainret = app.exec();
+    qDebug() << "mainloop exited with code:" << mainret;
+
+    // queue is FIFO, so transactions finish in order they were started
+    for (int i = 0; i < finishOrder.size(); i++) {
+        if (finishOrder.at(i) != i) {
+            qWarning() << "FAIL: transactions finished out of order:" << finishOrder;
+            mainret = 1;
+            break;
+        }
+    }
+
+    if (!failed.contains(iAddBad)) {
+        qWarning() << "FAIL: add of non-existing package must fail";
+        mainret = 1;
+    }
+    // with fresh indexes, good add must not be failed by its bad neighbours
+    if (!failed.contains(iUpdate) && failed.contains(iAddGood)) {
+        qWarning() << "FAIL: add failed together with a bad add queued after it";
+        mainret = 1;
+    }
+
+    db.close();
+    return mainret;
+}
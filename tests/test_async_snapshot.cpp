@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QObject>
+#include <QTimer>
+
+#include <QtApk>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int ret = 0;
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    QtApk::DatabaseAsync db;
+
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READWRITE | QtApk::QTAPK_OPENF_ENABLE_PROGRESSFD)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+
+    // just to be safe, exit in any case in 180 seconds
+    QTimer::singleShot(180000, &app, []() {
+        qDebug() << "Quitting by timer!";
+        QCoreApplication::exit(100);
+    });
+
+    const int numInstalled = db.getInstalledPackages().size();
+    const int numAvailable = db.getAvailablePackages().size();
+    qDebug() << "Before:" << numInstalled << "installed," << numAvailable << "available";
+
+    // change installed set and change it back: install fish,
+    //    or remove it first if some earlier test left it installed
+    const QString pkgName = QStringLiteral("fish");
+    bool wasInstalled = false;
+    for (const QtApk::Package &pkg : db.getInstalledPackages(QtApk::QTAPK_FIELD_NAME)) {
+        if (pkg.name == pkgName) {
+            wasInstalled = true;
+            break;
+        }
+    }
+    QtApk::Transaction *first = wasInstalled ? db.del(pkgName) : db.add(pkgName);
+    QtApk::Transaction *second = wasInstalled ? db.add(pkgName) : db.del(pkgName);
+    if (!first || !second) {
+        qWarning() << "FAIL: could not create transaction";
+        return 1;
+    }
+
+    // query repeatedly while transactions are running in background;
+    //    every result must be a complete installed set, from before
+    //    or after the first transaction, never a partial one
+    QTimer pollTimer;
+    int numPolls = 0;
+    QVector<int> seenInstalled;
+    QObject::connect(&pollTimer, &QTimer::timeout, [&]() {
+        numPolls++;
+        const QVector<QtApk::Package> installed = db.getInstalledPackages();
+        const int n = installed.size();
+        // snapshot keeps only a few fields, names and versions among them
+        for (const QtApk::Package &pkg : installed) {
+            if (pkg.name.isEmpty() || pkg.version.isEmpty()) {
+                qWarning() << "FAIL: installed package without name or version";
+                ret = 1;
+                break;
+            }
+        }
+        if (!seenInstalled.contains(n)) {
+            seenInstalled.append(n);
+        }
+        if (db.getAvailablePackages().size() != numAvailable) {
+            qWarning() << "FAIL: available packages changed during add/del";
+            ret = 1;
+        }
+    });
+
+    bool firstOk = true;
+    bool secondOk = true;
+    int numAfterFirst = -1;
+    QObject::connect(first, &QtApk::Transaction::errorOccured, [&firstOk](QString msg) {
+        // not an error here, may fail without network access
+        qWarning() << "first transaction failed:" << msg;
+        firstOk = false;
+    });
+    QObject::connect(second, &QtApk::Transaction::errorOccured, [&secondOk](QString msg) {
+        qWarning() << "second transaction failed:" << msg;
+        secondOk = false;
+    });
+    // second one is started only now, so that nothing changes
+    //    installed set while it is counted
+    QObject::connect(first, &QtApk::Transaction::finished, [&]() {
+        numAfterFirst = db.getInstalledPackages().size();
+        first->deleteLater();
+        second->start();
+    });
+    QObject::connect(second, &QtApk::Transaction::finished, [&]() {
+        pollTimer.stop();
+        second->deleteLater();
+        QTimer::singleShot(1000, &app, &QCoreApplication::quit);
+    });
+
+    first->start();
+    pollTimer.start(10);
+
+    int mainret = app.exec();
+    qDebug() << "mainloop exited with code:" << mainret << "; polled" << numPolls << "times";
+    if (mainret != 0) {
+        ret = mainret;
+    }
+
+    qDebug() << "Installed counts seen:" << seenInstalled << "; after first:" << numAfterFirst;
+    if (firstOk) {
+        if (numAfterFirst == numInstalled) {
+            qWarning() << "FAIL: installed packages did not change after" << (wasInstalled ? "del" : "add");
+            ret = 1;
+        }
+        for (const int n : seenInstalled) {
+            if (n != numInstalled && n != numAfterFirst) {
+                qWarning() << "FAIL: query returned partial installed set:" << n;
+                ret = 1;
+            }
+        }
+        if (secondOk && db.getInstalledPackages().size() != numInstalled) {
+            qWarning() << "FAIL: installed packages not restored";
+            ret = 1;
+        }
+    }
+
+    db.close();
+    return ret;
+}
@@ -40,14 +40,47 @@ int main(int argc, char *argv[])
         qDebug() << "OK: fake upgrade run was OK!";
         const QVector<QtApk::ChangesetItem> &ch = changes.changes();
         qDebug() << "Number of changes:" << ch.size();
+        qDebug() << "Download size:" << changes.downloadSize()
+                 << "; installed size delta:" << changes.installedSizeDelta();
         int i = 0;
+        quint64 itemsDownloadSize = 0;
         for (const QtApk::ChangesetItem &it : ch) {
             qDebug() << i << ":";
             qDebug() << "  " << it.oldPackage.name << " == " << it.newPackage.name;
             qDebug() << "  " << it.oldPackage.version << " > " << it.newPackage.version;
-            qDebug() << "  reinstall: " << it.reinstall;
+            qDebug() << "  reinstall: " << it.reinstall << "; download:" << it.downloadSize;
+            itemsDownloadSize += it.downloadSize;
+            // compact item: plain fields match compact packages
+            if (it.name.isEmpty() || it.oldVersion != it.oldPackage.version
+                    || it.newVersion != it.newPackage.version) {
+                qWarning() << "FAIL: inconsistent compact item" << it.name;
+                ret = 1;
+            }
+            // full information is available on demand, and stays
+            //    consistent with item sizes
+            if (!it.newVersion.isEmpty()) {
+                bool found = false;
+                for (const QtApk::Package &p : db.findPackage(it.name)) {
+                    if (p.version == it.newVersion) {
+                        found = true;
+                        if (p.installedSize != it.newInstalledSize) {
+                            qWarning() << "FAIL: installed size mismatch for" << it.name;
+                            ret = 1;
+                        }
+                    }
+                }
+                if (!found) {
+                    qWarning() << "FAIL: new package not found on demand:" << it.name << it.newVersion;
+                    ret = 1;
+                }
+            }
             i++;
         }
+        // items with unchanged version are not listed, but counted in totals
+        if (itemsDownloadSize > changes.downloadSize()) {
+            qWarning() << "FAIL: download size total is less than sum of items";
+            ret = 1;
+        }
     }
 
     db.close();
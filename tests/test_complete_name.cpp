@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <QtApk>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int ret = 0;
+    QtApk::Database db;
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READONLY)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+
+    const QStringList prefixes = {
+        QStringLiteral("py3-"),
+        QStringLiteral("linux-"),
+        QStringLiteral("so:"),
+        QStringLiteral("cmd:"),
+    };
+
+    for (const QString &prefix : prefixes) {
+        QElapsedTimer timer;
+        timer.start();
+        const QStringList names = db.completeName(prefix, 10);
+        const qint64 us = timer.nsecsElapsed() / 1000;
+        qDebug() << prefix << "->" << names << "(" << us << "us )";
+
+        if (names.size() > 10) {
+            qWarning() << "FAIL: limit was not respected";
+            ret = 1;
+        }
+        for (int i = 0; i < names.size(); i++) {
+            if (!names.at(i).startsWith(prefix)) {
+                qWarning() << "FAIL: name" << names.at(i) << "does not start with" << prefix;
+                ret = 1;
+            }
+            if (i > 0 && names.at(i - 1).toUtf8() >= names.at(i).toUtf8()) {
+                qWarning() << "FAIL: names are not sorted / unique";
+                ret = 1;
+            }
+        }
+    }
+
+    // every available package name must be completed by itself
+    const QVector<QtApk::Package> pkgs = db.getAvailablePackages(QtApk::QTAPK_FIELD_NAME);
+    for (const QtApk::Package &p : pkgs) {
+        if (!db.completeName(p.name, 1000).contains(p.name)) {
+            qWarning() << "FAIL: name" << p.name << "was not completed";
+            ret = 1;
+            break;
+        }
+    }
+
+    if (!db.completeName(QStringLiteral("qtapk-no-such-name-")).isEmpty()) {
+        qWarning() << "FAIL: completed a name that does not exist";
+        ret = 1;
+    }
+
+    db.close();
+    return ret;
+}
@@ -24,6 +24,8 @@ int main(int argc, char *argv[])
     
     if (parser.isSet(root_option)) {
         db.setFakeRoot(parser.value(root_option));
+        // for getRepositories() / saveRepositories()
+        qputenv("QTAPK_FAKEROOT", parser.value(root_option).toUtf8());
     }
 
     if (!db.open(QtApk::QTAPK_OPENF_READWRITE)) {
@@ -32,7 +34,8 @@ int main(int argc, char *argv[])
     }
     qDebug() << "OK: DB was opened!";
 
-    if (!db.updatePackageIndex(QtApk::QTAPK_UPDATE_ALLOW_UNTRUSTED)) {
+    QVector<QtApk::RepositoryUpdateResult> results;
+    if (!db.updatePackageIndex(QtApk::QTAPK_UPDATE_ALLOW_UNTRUSTED, &results)) {
         qWarning() << "WARNING: Failed to update DB!";
         ret = 1;
     } else {
@@ -40,6 +43,73 @@ int main(int argc, char *argv[])
         qDebug() << db.upgradeablePackagesCount() << " packages can be updated.";
     }
 
+    // one record per repository, even when some of them failed
+    if (results.isEmpty() || results.size() != db.repositoryRefreshTimes().size()) {
+        qWarning() << "FAIL: expected one update result per repository, got" << results.size();
+        ret = 1;
+    }
+    for (const QtApk::RepositoryUpdateResult &res : results) {
+        qDebug() << res.url << res.statusString << res.bytesFetched << "bytes"
+                 << res.wallTimeMs << "ms; changed:" << res.indexChanged
+                 << "; packages:" << res.packageCount;
+        if (res.url.isEmpty() || res.statusString.isEmpty()) {
+            qWarning() << "FAIL: update result is incomplete";
+            ret = 1;
+        }
+        if (res.isOk() && !res.indexChanged && res.bytesFetched != 0) {
+            qWarning() << "FAIL: unchanged index must not count fetched bytes";
+            ret = 1;
+        }
+        if (res.indexChanged ? (res.packageCount != -1) : (res.packageCount < 0)) {
+            qWarning() << "FAIL: package count must be -1 for changed index only:" << res.packageCount;
+            ret = 1;
+        }
+    }
+
     db.close();
+
+    // one unreachable mirror among good ones: update must fail for it
+    //    only, other repositories are still fetched, in parallel
+    const QVector<QtApk::Repository> savedRepos = QtApk::Database::getRepositories();
+    QVector<QtApk::Repository> repos = savedRepos;
+    const QString badUrl = QStringLiteral("http://127.0.0.1:9/alpine/v3.11/main");
+    repos.prepend(QtApk::Repository(badUrl, QStringLiteral("failing mirror"), true));
+    if (!QtApk::Database::saveRepositories(repos)) {
+        qWarning() << "FAIL: could not save repositories";
+        return 1;
+    }
+    if (!db.open(QtApk::QTAPK_OPENF_READWRITE)) {
+        qWarning() << "Failed to open APK DB with failing mirror!";
+        QtApk::Database::saveRepositories(savedRepos);
+        return 1;
+    }
+    results.clear();
+    const QtApk::DbUpdateFlags forceFlags = static_cast<QtApk::DbUpdateFlags>(
+                QtApk::QTAPK_UPDATE_ALLOW_UNTRUSTED | QtApk::QTAPK_UPDATE_FORCE);
+    if (db.updatePackageIndex(forceFlags, &results)) {
+        qWarning() << "FAIL: update with failing mirror must fail";
+        ret = 1;
+    }
+    int numFailed = 0;
+    for (const QtApk::RepositoryUpdateResult &res : results) {
+        qDebug() << res.url << res.statusString;
+        if (res.url == badUrl) {
+            if (res.isOk()) {
+                qWarning() << "FAIL: failing mirror reported success";
+                ret = 1;
+            }
+            numFailed++;
+        } else if (!res.isOk()) {
+            qWarning() << "FAIL: good mirror failed next to a failing one:" << res.url << res.statusString;
+            ret = 1;
+        }
+    }
+    if (numFailed != 1) {
+        qWarning() << "FAIL: expected one result for failing mirror, got" << numFailed;
+        ret = 1;
+    }
+    db.close();
+    QtApk::Database::saveRepositories(savedRepos);
+
     return ret;
 }
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <QtApk>
+
+static bool checkGraph(const QtApk::DependencyGraph &g)
+{
+    const int n = g.nodeCount();
+
+    if (g.offsets().size() != n + 1 || g.reverseOffsets().size() != n + 1) {
+        qWarning() << "FAIL: offsets arrays must have nodeCount()+1 items";
+        return false;
+    }
+    if (g.offsets().last() != g.edgeCount() || g.reverseOffsets().last() != g.edgeCount()
+            || g.kinds().size() != g.edgeCount() || g.reverseTargets().size() != g.edgeCount()) {
+        qWarning() << "FAIL: edge arrays sizes mismatch";
+        return false;
+    }
+    for (int node = 0; node < n; node++) {
+        if (g.nodeId(g.nodeName(node)) != node) {
+            qWarning() << "FAIL: nodeId() lookup failed for" << g.nodeName(node);
+            return false;
+        }
+        // every forward edge must be present in reverse arrays
+        for (int e = g.offsets().at(node); e < g.offsets().at(node + 1); e++) {
+            const int target = g.targets().at(e);
+            bool found = false;
+            for (int r = g.reverseOffsets().at(target); r < g.reverseOffsets().at(target + 1); r++) {
+                if (g.reverseTargets().at(r) == node && g.reverseKinds().at(r) == g.kinds().at(e)) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                qWarning() << "FAIL: no reverse edge for" << g.nodeName(node) << "->" << g.nodeName(target);
+                return false;
+            }
+        }
+    }
+    if (g.nodeId(QStringLiteral("this-package-does-not-exist")) != -1) {
+        qWarning() << "FAIL: nodeId() found non-existing name";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int ret = 0;
+    QtApk::Database db;
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READONLY)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const QtApk::DependencyGraph installed = db.getInstalledDependencyGraph();
+    qDebug() << "Installed graph:" << installed.nodeCount() << "nodes,"
+             << installed.edgeCount() << "edges in" << timer.elapsed() << "ms";
+    if (!checkGraph(installed)) {
+        ret = 1;
+    }
+
+    for (const QtApk::Package &pkg : db.getInstalledPackages(QtApk::QTAPK_FIELD_NAME)) {
+        const int node = installed.nodeId(pkg.name);
+        if (node < 0 || !installed.isPackage(node)) {
+            qWarning() << "FAIL: installed package" << pkg.name << "is not a package node";
+            ret = 1;
+            break;
+        }
+    }
+
+    timer.restart();
+    const QtApk::DependencyGraph available = db.getAvailableDependencyGraph();
+    qDebug() << "Available graph:" << available.nodeCount() << "nodes,"
+             << available.edgeCount() << "edges in" << timer.elapsed() << "ms";
+    if (!checkGraph(available)) {
+        ret = 1;
+    }
+
+    db.close();
+
+    // graph is a standalone copy
+    if (installed.nodeCount() > 0 && installed.nodeName(0).isEmpty()) {
+        qWarning() << "FAIL: graph must stay valid after database is closed";
+        ret = 1;
+    }
+    if (!db.getInstalledDependencyGraph().isEmpty()) {
+        qWarning() << "FAIL: closed database must return empty graph";
+        ret = 1;
+    }
+    return ret;
+}
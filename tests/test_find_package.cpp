@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <QtApk>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int ret = 0;
+    QtApk::Database db;
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READONLY)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+
+    // every installed package must be found by name
+    const QVector<QtApk::Package> installed = db.getInstalledPackages();
+    for (const QtApk::Package &p : installed) {
+        const QtApk::Package found = db.findInstalled(p.name);
+        if (found.name != p.name || found.version != p.version) {
+            qWarning() << "FAIL: findInstalled(" << p.name << ") returned"
+                       << found.name << found.version;
+            ret = 1;
+        }
+    }
+
+    // every available package must be among providers of its name
+    const QVector<QtApk::Package> available = db.getAvailablePackages(
+                QtApk::QTAPK_FIELD_NAME | QtApk::QTAPK_FIELD_VERSION);
+    QElapsedTimer timer;
+    timer.start();
+    for (const QtApk::Package &p : available) {
+        const QVector<QtApk::Package> providers = db.findPackage(
+                    p.name, QtApk::QTAPK_FIELD_NAME | QtApk::QTAPK_FIELD_VERSION);
+        bool ok = false;
+        for (const QtApk::Package &prov : providers) {
+            if (prov.name == p.name && prov.version == p.version) {
+                ok = true;
+                break;
+            }
+        }
+        if (!ok) {
+            qWarning() << "FAIL: findPackage(" << p.name << ") did not return version" << p.version;
+            ret = 1;
+            break;
+        }
+    }
+    qDebug() << available.size() << "lookups took" << timer.elapsed() << "ms";
+
+    const QString bogusName(QStringLiteral("this-package-does-not-exist-qtapk"));
+    if (!db.findPackage(bogusName).isEmpty() || !db.findInstalled(bogusName).isEmpty()) {
+        qWarning() << "FAIL: found package that does not exist!";
+        ret = 1;
+    }
+
+    db.close();
+    return ret;
+}
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDebug>
+
+#include <QtApk>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int ret = 0;
+    QtApk::Database db;
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READONLY)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+
+    // count packages without building any vector
+    int numPython = 0;
+    const int numAvailable = db.forEachAvailablePackage([&numPython](const QtApk::PackageView &pkg) {
+        if (pkg.name().startsWith(QLatin1String("py3-"))) {
+            numPython++;
+        }
+        return true;
+    });
+    qDebug() << "Available:" << numAvailable << "; py3- packages:" << numPython;
+
+    if (numAvailable != db.getAvailablePackageViews().size()) {
+        qWarning() << "FAIL: visitor did not see all available packages!";
+        ret = 1;
+    }
+
+    // early termination
+    const int stopAfter = qMin(10, numAvailable);
+    int seen = 0;
+    const int numVisited = db.forEachAvailablePackage([&seen, stopAfter](const QtApk::PackageView &) {
+        seen++;
+        return seen < stopAfter;
+    });
+    if (numVisited != stopAfter) {
+        qWarning() << "FAIL: visitor was not stopped after" << stopAfter
+                   << "packages, visited:" << numVisited;
+        ret = 1;
+    }
+
+    QStringList installedNames;
+    const int numInstalled = db.forEachInstalledPackage([&installedNames](const QtApk::PackageView &pkg) {
+        installedNames.append(pkg.name());
+        return true;
+    });
+    qDebug() << "Installed:" << numInstalled << installedNames;
+    if (numInstalled != db.getInstalledPackages().size()) {
+        qWarning() << "FAIL: visitor did not see all installed packages!";
+        ret = 1;
+    }
+
+    db.close();
+    return ret;
+}
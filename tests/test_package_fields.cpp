@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <QtApk>
+
+// how many times to repeat each query to get stable timings
+static const int NUM_ROUNDS = 5;
+
+static qint64 benchAvailable(const QtApk::Database &db, QtApk::PackageFields fields,
+                             QtApk::DbQueryFlags qflags = QtApk::QTAPK_QUERY_DEFAULT)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < NUM_ROUNDS; i++) {
+        const QVector<QtApk::Package> pkgs = db.getAvailablePackages(fields, qflags);
+        Q_UNUSED(pkgs)
+    }
+    return timer.nsecsElapsed() / NUM_ROUNDS;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int ret = 0;
+    QtApk::Database db;
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READONLY)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+
+    const QtApk::PackageFields nameVersion = QtApk::QTAPK_FIELD_NAME | QtApk::QTAPK_FIELD_VERSION;
+
+    const QVector<QtApk::Package> full = db.getAvailablePackages();
+    const QVector<QtApk::Package> projected = db.getAvailablePackages(nameVersion);
+
+    if (full.size() != projected.size()) {
+        qWarning() << "FAIL: projection changed number of packages!";
+        ret = 1;
+    }
+    for (int i = 0; i < qMin(full.size(), projected.size()); i++) {
+        const QtApk::Package &p = projected.at(i);
+        if (p.name != full.at(i).name || p.version != full.at(i).version) {
+            qWarning() << "FAIL: name/version differ for" << p.name;
+            ret = 1;
+            break;
+        }
+        if (!p.description.isEmpty() || !p.url.isEmpty() || p.size != 0) {
+            qWarning() << "FAIL: fields that were not requested are filled in for" << p.name;
+            ret = 1;
+            break;
+        }
+    }
+
+    // parallel conversion must give exactly the same result, in the same order
+    const QVector<QtApk::Package> parallel = db.getAvailablePackages(
+                QtApk::QTAPK_FIELD_ALL, QtApk::QTAPK_QUERY_PARALLEL);
+    if (parallel.size() != full.size()) {
+        qWarning() << "FAIL: parallel conversion changed number of packages!";
+        ret = 1;
+    }
+    for (int i = 0; i < qMin(full.size(), parallel.size()); i++) {
+        if (parallel.at(i).name != full.at(i).name
+                || parallel.at(i).version != full.at(i).version
+                || parallel.at(i).description != full.at(i).description) {
+            qWarning() << "FAIL: parallel conversion result differs at" << i;
+            ret = 1;
+            break;
+        }
+    }
+
+    const qint64 tFull = benchAvailable(db, QtApk::QTAPK_FIELD_ALL);
+    const qint64 tNameVersion = benchAvailable(db, nameVersion);
+    const qint64 tParallel = benchAvailable(db, QtApk::QTAPK_FIELD_ALL, QtApk::QTAPK_QUERY_PARALLEL);
+    qDebug() << full.size() << "available packages";
+    qDebug() << "All fields:           " << tFull / 1000 << "us";
+    qDebug() << "Name + version:       " << tNameVersion / 1000 << "us";
+    qDebug() << "All fields, parallel: " << tParallel / 1000 << "us";
+    if (tNameVersion > 0) {
+        qDebug() << "Speedup (name + version):" << static_cast<double>(tFull) / static_cast<double>(tNameVersion);
+    }
+    if (tParallel > 0) {
+        qDebug() << "Speedup (parallel):" << static_cast<double>(tFull) / static_cast<double>(tParallel);
+    }
+
+    db.close();
+    return ret;
+}
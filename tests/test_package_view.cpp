@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDebug>
+
+#include <QtApk>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int ret = 0;
+    QtApk::Database db;
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READONLY)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+
+    const QVector<QtApk::Package> all = db.getAvailablePackages();
+    const QVector<QtApk::PackageView> allViews = db.getAvailablePackageViews();
+    qDebug() << "Available:" << all.size() << "packages," << allViews.size() << "views";
+
+    if (all.size() != allViews.size()) {
+        qWarning() << "FAIL: number of views does not match number of packages!";
+        ret = 1;
+    } else {
+        // both are enumerated in the same order from libapk's hash
+        for (int i = 0; i < all.size(); i++) {
+            const QtApk::Package pkg = allViews.at(i).toPackage();
+            if (pkg.name != all.at(i).name || pkg.version != all.at(i).version
+                    || allViews.at(i).description() != all.at(i).description) {
+                qWarning() << "FAIL: view" << i << "differs:"
+                           << allViews.at(i).name() << "vs" << all.at(i).name;
+                ret = 1;
+                break;
+            }
+        }
+    }
+
+    const QVector<QtApk::PackageView> installedViews = db.getInstalledPackageViews();
+    qDebug() << "Installed:" << installedViews.size() << "views";
+    if (installedViews.size() != db.getInstalledPackages().size()) {
+        qWarning() << "FAIL: number of installed views does not match!";
+        ret = 1;
+    }
+
+    if (!QtApk::PackageView().isNull() || !QtApk::PackageView().toPackage().isEmpty()) {
+        qWarning() << "FAIL: default constructed view must be null";
+        ret = 1;
+    }
+
+    db.close();
+    return ret;
+}
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDebug>
+
+#include <QtApk>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int ret = 0;
+    QtApk::Database db;
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READWRITE)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+    qDebug() << "OK: DB was opened!";
+
+    if (QtApk::Plan().isValid()) {
+        qWarning() << "FAIL: default constructed plan must be invalid";
+        ret = 1;
+    }
+
+    QtApk::Plan upgradePlan = db.prepareUpgrade();
+    if (!upgradePlan.isValid()) {
+        qWarning() << "FAIL: upgrade plan is not valid";
+        ret = 1;
+    }
+    const QtApk::Changeset &changes = upgradePlan.changeset();
+    qDebug() << "Upgrade plan: install" << changes.numInstall()
+             << "remove" << changes.numRemove() << "adjust" << changes.numAdjust();
+
+    // simulated upgrade must come to the same result
+    QtApk::Changeset simulated;
+    db.upgrade(QtApk::QTAPK_UPGRADE_SIMULATE, &simulated);
+    if (simulated.numInstall() != changes.numInstall()
+            || simulated.numAdjust() != changes.numAdjust()
+            || simulated.changes().size() != changes.changes().size()) {
+        qWarning() << "FAIL: plan differs from simulated upgrade";
+        ret = 1;
+    }
+
+    // move keeps the plan valid
+    QtApk::Plan moved = std::move(upgradePlan);
+    if (upgradePlan.isValid() || !moved.isValid()) {
+        qWarning() << "FAIL: plan was not moved correctly";
+        ret = 1;
+    }
+
+    // invalid spec gives invalid plan
+    if (db.prepareAdd(QStringList(QStringLiteral("not a valid spec"))).isValid()) {
+        qWarning() << "FAIL: plan with invalid spec must be invalid";
+        ret = 1;
+    }
+
+    // any change of database state makes plan invalid
+    QtApk::Plan addPlan = db.prepareAdd(QStringList(QStringLiteral("fish")));
+    qDebug() << "Add plan valid:" << addPlan.isValid()
+             << "to install:" << addPlan.changeset().numInstall();
+    if (addPlan.isValid()) {
+        if (!addPlan.commit()) {
+            qWarning() << "Failed to commit add plan";
+            // not an error, fails in minimal chroot without
+            // repositories, but works in a full Alpine system
+        }
+        if (addPlan.isValid() || moved.isValid()) {
+            qWarning() << "FAIL: plans must be invalid after commit";
+            ret = 1;
+        }
+        if (addPlan.commit()) {
+            qWarning() << "FAIL: plan must not be committed twice";
+            ret = 1;
+        }
+    }
+
+    QtApk::Plan delPlan = db.prepareDel(QStringList(QStringLiteral("fish")));
+    db.close();
+    if (delPlan.isValid() || delPlan.commit()) {
+        qWarning() << "FAIL: plan must be invalid after database is closed";
+        ret = 1;
+    }
+    return ret;
+}
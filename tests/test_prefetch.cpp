@@ -0,0 +1,271 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QThread>
+
+#include <QtApk>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * Minimal HTTP/1.0 server on loopback interface, serves files from
+ * one directory. Used as a repository mirror, so that test does
+ * not depend on network access.
+ */
+class LoopbackMirror : public QThread
+{
+public:
+    explicit LoopbackMirror(const QString &dir) : m_dir(dir) {}
+
+    ~LoopbackMirror() override
+    {
+        stop();
+    }
+
+    //! starts listening on random port, returns false on error
+    bool start()
+    {
+        m_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (m_fd < 0) {
+            return false;
+        }
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        socklen_t len = sizeof(addr);
+        if (::bind(m_fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0
+                || ::listen(m_fd, 8) < 0
+                || ::getsockname(m_fd, reinterpret_cast<struct sockaddr *>(&addr), &len) < 0) {
+            ::close(m_fd);
+            m_fd = -1;
+            return false;
+        }
+        m_port = ntohs(addr.sin_port);
+        QThread::start();
+        return true;
+    }
+
+    void stop()
+    {
+        m_stop = true;
+        wait();
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    QString url() const
+    {
+        return QStringLiteral("http://127.0.0.1:%1").arg(m_port);
+    }
+
+    int numRequests() const { return m_numRequests; }
+
+protected:
+    void run() override
+    {
+        while (!m_stop) {
+            struct pollfd pfd = { m_fd, POLLIN, 0 };
+            if (::poll(&pfd, 1, 100) <= 0) {
+                continue;
+            }
+            const int client = ::accept(m_fd, nullptr, nullptr);
+            if (client < 0) {
+                continue;
+            }
+            serve(client);
+            ::close(client);
+        }
+    }
+
+private:
+    void serve(int client)
+    {
+        QByteArray request;
+        char buf[1024];
+        while (!request.contains("\r\n\r\n") && request.size() < 8192) {
+            const ssize_t r = ::read(client, buf, sizeof(buf));
+            if (r <= 0) {
+                return;
+            }
+            request.append(buf, static_cast<int>(r));
+        }
+        // "GET /x86_64/APKINDEX.tar.gz HTTP/1.1"
+        const QList<QByteArray> requestLine = request.left(request.indexOf("\r\n")).split(' ');
+        m_numRequests++;
+        QByteArray body;
+        bool found = false;
+        if (requestLine.size() == 3 && requestLine.at(0) == "GET"
+                && !requestLine.at(1).contains("..")) {
+            QFile f(m_dir + QString::fromUtf8(requestLine.at(1)));
+            if (f.open(QIODevice::ReadOnly)) {
+                body = f.readAll();
+                found = true;
+            }
+        }
+        QByteArray response = found ? QByteArray("HTTP/1.0 200 OK\r\n")
+                                    : QByteArray("HTTP/1.0 404 Not Found\r\n");
+        response += "Content-Type: application/octet-stream\r\n";
+        response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+        response += "Connection: close\r\n\r\n";
+        response += body;
+        const char *p = response.constData();
+        qint64 left = response.size();
+        while (left > 0) {
+            const ssize_t w = ::write(client, p, static_cast<size_t>(left));
+            if (w <= 0) {
+                return;
+            }
+            p += w;
+            left -= w;
+        }
+    }
+
+    QString m_dir;
+    int m_fd = -1;
+    quint16 m_port = 0;
+    QAtomicInt m_stop;
+    QAtomicInt m_numRequests;
+};
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int ret = 0;
+    QtApk::Database db;
+    QString cacheLink;
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+    QCommandLineOption repo_option(
+        QStringLiteral("repo"), QStringLiteral("Local test repository dir path"),
+        QStringLiteral("repo"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addOption(repo_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    if (!parser.isSet(root_option) || !parser.isSet(repo_option)) {
+        qWarning() << "FAIL: both --root and --repo are required";
+        return 1;
+    }
+
+    const QString root = parser.value(root_option);
+    db.setFakeRoot(root);
+    // for getRepositories() / saveRepositories()
+    qputenv("QTAPK_FAKEROOT", root.toUtf8());
+    // enable package cache inside fake root, the same way
+    //    "setup-apkcache" does it on a real system
+    QDir(root).mkpath(QStringLiteral("var/cache/apk"));
+    cacheLink = root + QStringLiteral("/etc/apk/cache");
+    if (!QFile::exists(cacheLink)) {
+        QFile::link(QStringLiteral("../../var/cache/apk"), cacheLink);
+    }
+
+    // serve tests/testdata/localrepo over loopback and use it as
+    //    the only repository, its index is signed by the test key
+    //    that create_fakeroot.sh installs
+    LoopbackMirror mirror(parser.value(repo_option));
+    if (!mirror.start()) {
+        qWarning() << "FAIL: could not start loopback mirror";
+        return 1;
+    }
+    const QVector<QtApk::Repository> savedRepos = QtApk::Database::getRepositories();
+    QVector<QtApk::Repository> repos;
+    repos << QtApk::Repository(mirror.url(), QStringLiteral("loopback test mirror"), true);
+    if (!QtApk::Database::saveRepositories(repos)) {
+        qWarning() << "FAIL: could not save repositories";
+        return 1;
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READWRITE)) {
+        qWarning() << "Failed to open APK DB!";
+        QtApk::Database::saveRepositories(savedRepos);
+        return 1;
+    }
+    qDebug() << "OK: DB was opened!";
+
+    if (!db.updatePackageIndex()) {
+        qWarning() << "FAIL: could not fetch index from loopback mirror";
+        ret = 1;
+    }
+    // index is loaded when DB is opened
+    db.close();
+    if (!db.open(QtApk::QTAPK_OPENF_READWRITE)) {
+        qWarning() << "Failed to reopen APK DB!";
+        QtApk::Database::saveRepositories(savedRepos);
+        return 1;
+    }
+
+    int numProgress = 0;
+    bool progressOk = true;
+    db.setDownloadProgressCallback([&numProgress, &progressOk](const QtApk::DownloadProgress &progress) {
+        numProgress++;
+        // package sizes are known from index
+        if (progress.url.isEmpty() || progress.bytesTotal <= 0 || progress.bytesDone < 0) {
+            progressOk = false;
+        }
+    });
+
+    if (QtApk::Plan().prefetch()) {
+        qWarning() << "FAIL: prefetch of invalid plan must fail";
+        ret = 1;
+    }
+
+    // "qtapk-test" depends on "qtapk-test-data", two downloads
+    QtApk::Plan plan = db.prepareAdd(QStringList(QStringLiteral("qtapk-test")));
+    qDebug() << "Add plan valid:" << plan.isValid()
+             << "download size:" << plan.changeset().downloadSize();
+    if (!plan.isValid() || plan.changeset().downloadSize() <= 0) {
+        qWarning() << "FAIL: expected valid plan with packages to download";
+        ret = 1;
+    } else if (!plan.prefetch(2)) {
+        qWarning() << "FAIL: failed to prefetch packages from loopback mirror";
+        ret = 1;
+    } else {
+        if (!plan.isValid()) {
+            qWarning() << "FAIL: prefetch must not invalidate plan";
+            ret = 1;
+        }
+        if (plan.changeset().downloadSize() != 0) {
+            qWarning() << "FAIL: nothing must be left to download after prefetch:"
+                       << plan.changeset().downloadSize();
+            ret = 1;
+        }
+        qDebug() << "Download progress reported" << numProgress << "times";
+        if (numProgress == 0 || !progressOk) {
+            qWarning() << "FAIL: invalid download progress reported";
+            ret = 1;
+        }
+        // commit reads packages from cache, mirror is not asked again
+        const int numRequests = mirror.numRequests();
+        if (!plan.commit()) {
+            qWarning() << "FAIL: failed to commit prefetched plan";
+            ret = 1;
+        } else if (mirror.numRequests() != numRequests) {
+            qWarning() << "FAIL: commit downloaded prefetched packages again";
+            ret = 1;
+        }
+        db.del(QStringLiteral("qtapk-test"));
+    }
+
+    db.close();
+    mirror.stop();
+    QtApk::Database::saveRepositories(savedRepos);
+    QFile::remove(cacheLink);
+    return ret;
+}
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <QtApk>
+
+/**
+ * Reads everything that is available in fd without waiting
+ * @return number of bytes read
+ */
+static int drain_fd(int fd)
+{
+    int total = 0;
+    char buf[4096];
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    while (::poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN)) {
+        const ssize_t nr = ::read(fd, buf, sizeof(buf));
+        if (nr <= 0) {
+            break;
+        }
+        total += static_cast<int>(nr);
+    }
+    return total;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int ret = 0;
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    QtApk::Database db;
+    QtApk::Database *other = new QtApk::Database();
+
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+        other->setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READWRITE | QtApk::QTAPK_OPENF_ENABLE_PROGRESSFD)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+    if (!other->open(QtApk::QTAPK_OPENF_READONLY | QtApk::QTAPK_OPENF_ENABLE_PROGRESSFD)) {
+        qWarning() << "Failed to open second APK DB!";
+        return 1;
+    }
+    if (db.progressFd() <= 0 || other->progressFd() <= 0 || db.progressFd() == other->progressFd()) {
+        qWarning() << "FAIL: each database must have its own progress fd:"
+                   << db.progressFd() << other->progressFd();
+        ret = 1;
+    }
+
+    // progress of db's commit must not go to other's pipe
+    if (!db.add(QStringLiteral("fish"))) {
+        qWarning() << "Failed to add package, cannot check progress";
+    } else {
+        const int own = drain_fd(db.progressFd());
+        const int foreign = drain_fd(other->progressFd());
+        qDebug() << "Progress bytes: own" << own << "; other database:" << foreign;
+        if (own == 0) {
+            qWarning() << "FAIL: no progress in database's own pipe";
+            ret = 1;
+        }
+        if (foreign != 0) {
+            qWarning() << "FAIL: progress leaked into another database's pipe";
+            ret = 1;
+        }
+    }
+
+    // destroying another database must not break progress reporting
+    other->close();
+    delete other;
+    other = nullptr;
+    if (db.del(QStringLiteral("fish"))) {
+        if (drain_fd(db.progressFd()) == 0) {
+            qWarning() << "FAIL: no progress after another database was destroyed";
+            ret = 1;
+        }
+    } else {
+        qWarning() << "Failed to delete package, cannot check progress";
+    }
+
+    db.close();
+    return ret;
+}
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <QtApk>
+
+static bool matches(const QtApk::PackageView &pkg, const QString &term)
+{
+    return pkg.name().contains(term, Qt::CaseInsensitive)
+            || pkg.origin().contains(term, Qt::CaseInsensitive)
+            || pkg.description().contains(term, Qt::CaseInsensitive);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int ret = 0;
+    QtApk::Database db;
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READONLY)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    // first search builds the index
+    QVector<QtApk::PackageView> found = db.search(QStringLiteral("Python"));
+    qDebug() << "First search (with index build):" << timer.nsecsElapsed() / 1000 << "us";
+    if (found.isEmpty()) {
+        qWarning() << "FAIL: nothing found for \"python\"";
+        ret = 1;
+    }
+    for (const QtApk::PackageView &pkg : found) {
+        if (!matches(pkg, QStringLiteral("python"))) {
+            qWarning() << "FAIL: unrelated result:" << pkg.name();
+            ret = 1;
+        }
+    }
+    // exact name match should be ranked first
+    if (!found.isEmpty() && !found.first().name().startsWith(QLatin1String("python"))) {
+        qWarning() << "FAIL: bad ranking, first result is:" << found.first().name();
+        ret = 1;
+    }
+
+    timer.restart();
+    found = db.search(QStringLiteral("library compression"), 10);
+    qDebug() << "Two-word search:" << timer.nsecsElapsed() / 1000 << "us";
+    if (found.size() > 10) {
+        qWarning() << "FAIL: limit was not respected";
+        ret = 1;
+    }
+    for (const QtApk::PackageView &pkg : found) {
+        qDebug() << "   " << pkg.name() << "-" << pkg.description();
+        if (!matches(pkg, QStringLiteral("library")) || !matches(pkg, QStringLiteral("compression"))) {
+            qWarning() << "FAIL: result does not match all words:" << pkg.name();
+            ret = 1;
+        }
+    }
+
+    if (!db.search(QStringLiteral("qtapk-no-such-text-anywhere")).isEmpty()) {
+        qWarning() << "FAIL: found something that does not exist";
+        ret = 1;
+    }
+
+    db.close();
+    return ret;
+}
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDebug>
+
+#include <QtApk>
+
+static void printChanges(const QtApk::Changeset &changes)
+{
+    qDebug() << "    install:" << changes.numInstall() << "remove:" << changes.numRemove()
+             << "adjust:" << changes.numAdjust();
+    for (const QtApk::ChangesetItem &item : changes.changes()) {
+        qDebug() << "   " << item.oldPackage.name << item.oldPackage.version
+                 << "=>" << item.newPackage.name << item.newPackage.version;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int ret = 0;
+    QtApk::Database db;
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READWRITE)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+    qDebug() << "OK: DB was opened!";
+
+    const int numInstalled = db.getInstalledPackages(QtApk::QTAPK_FIELD_NAME).size();
+    const QStringList pkgNames(QStringLiteral("fish"));
+
+    QtApk::Changeset addChanges;
+    if (db.add(pkgNames, QtApk::QTAPK_ADD_SIMULATE, &addChanges)) {
+        qDebug() << "Simulated add of" << pkgNames;
+        printChanges(addChanges);
+    } else {
+        qWarning() << "Failed to simulate add of" << pkgNames;
+        // not an error, fails in minimal chroot without
+        // repositories, but works in a full Alpine system
+    }
+
+    // pick some installed package to simulate its removal
+    const QVector<QtApk::Package> installed = db.getInstalledPackages(QtApk::QTAPK_FIELD_NAME);
+    if (!installed.isEmpty()) {
+        const QStringList delNames(installed.last().name);
+        QtApk::Changeset delChanges;
+        if (db.del(delNames, QtApk::QTAPK_DEL_SIMULATE, &delChanges)) {
+            qDebug() << "Simulated del of" << delNames;
+            printChanges(delChanges);
+        } else {
+            qWarning() << "Failed to simulate del of" << delNames;
+        }
+    }
+
+    // simulation must not change anything
+    if (db.getInstalledPackages(QtApk::QTAPK_FIELD_NAME).size() != numInstalled) {
+        qWarning() << "FAIL: simulation changed installed packages!";
+        ret = 1;
+    }
+
+    db.close();
+    return ret;
+}
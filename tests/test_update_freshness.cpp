@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDebug>
+
+#include <QtApk>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int ret = 0;
+    QtApk::Database db;
+    
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+    
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+    
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READWRITE)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+    qDebug() << "OK: DB was opened!";
+
+    if (db.indexMaxAge() != -1) {
+        qWarning() << "FAIL: default index max age must be -1";
+        ret = 1;
+    }
+
+    // make sure every repository has an index
+    const QtApk::DbUpdateFlags forceFlags = static_cast<QtApk::DbUpdateFlags>(
+                QtApk::QTAPK_UPDATE_ALLOW_UNTRUSTED | QtApk::QTAPK_UPDATE_FORCE);
+    if (!db.updatePackageIndex(forceFlags)) {
+        qWarning() << "WARNING: Failed to update DB!";
+    }
+
+    const QMap<QString, QDateTime> before = db.repositoryRefreshTimes();
+    qDebug() << "Refresh times:" << before;
+    if (before.isEmpty()) {
+        qWarning() << "FAIL: no repositories";
+        ret = 1;
+    }
+
+    // with a long max age nothing must be fetched again
+    db.setIndexMaxAge(365 * 24 * 60 * 60);
+    if (!db.updatePackageIndex(QtApk::QTAPK_UPDATE_ALLOW_UNTRUSTED)) {
+        qWarning() << "WARNING: Failed to update DB!";
+    }
+    const QMap<QString, QDateTime> after = db.repositoryRefreshTimes();
+    for (auto it = before.constBegin(); it != before.constEnd(); ++it) {
+        if (it.value().isValid() && after.value(it.key()) != it.value()) {
+            qWarning() << "FAIL: fresh index was fetched again:" << it.key();
+            ret = 1;
+        }
+    }
+
+    db.setIndexMaxAge(-5);
+    if (db.indexMaxAge() != -1) {
+        qWarning() << "FAIL: negative max age must reset to default";
+        ret = 1;
+    }
+
+    db.close();
+    return ret;
+}
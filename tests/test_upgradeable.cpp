@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QSet>
+
+#include <QtApk>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int ret = 0;
+    QtApk::Database db;
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READONLY)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+
+    QSet<QString> installedNames;
+    for (const QtApk::Package &pkg : db.getInstalledPackages(QtApk::QTAPK_FIELD_NAME)) {
+        installedNames.insert(pkg.name);
+    }
+
+    const QVector<QtApk::UpgradeablePackage> upgradeable = db.getUpgradeablePackages();
+    qDebug() << "Upgradeable:" << upgradeable.size() << "packages";
+
+    for (const QtApk::UpgradeablePackage &upkg : upgradeable) {
+        qDebug() << "   " << upkg.name << ":" << upkg.oldVersion << "=>" << upkg.newVersion;
+        if (!installedNames.contains(upkg.name)) {
+            qWarning() << "FAIL:" << upkg.name << "is not installed!";
+            ret = 1;
+        }
+        if (upkg.oldVersion.isEmpty() || upkg.newVersion.isEmpty()
+                || upkg.oldVersion == upkg.newVersion) {
+            qWarning() << "FAIL: bad versions for" << upkg.name;
+            ret = 1;
+        }
+    }
+
+    // solver may also pull in new dependencies or be limited
+    //    by world constraints, so the numbers are only informational
+    qDebug() << "Solver says:" << db.upgradeablePackagesCount() << "upgrades";
+
+    db.close();
+
+    if (!db.getUpgradeablePackages().isEmpty()) {
+        qWarning() << "FAIL: closed database must return no upgradeable packages";
+        ret = 1;
+    }
+    return ret;
+}
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <QtApk>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int ret = 0;
+    QtApk::Database db;
+
+    QCommandLineOption root_option(
+        QStringLiteral("root"), QStringLiteral("Fake root dir path"),
+        QStringLiteral("root"));
+
+    QCommandLineParser parser;
+    parser.addOption(root_option);
+    parser.addHelpOption();
+    parser.process(app);
+
+    if (parser.isSet(root_option)) {
+        db.setFakeRoot(parser.value(root_option));
+    }
+
+    if (!db.open(QtApk::QTAPK_OPENF_READONLY)) {
+        qWarning() << "Failed to open APK DB!";
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const int first = db.upgradeablePackagesCount();
+    const qint64 firstNs = timer.nsecsElapsed();
+
+    timer.restart();
+    const int second = db.upgradeablePackagesCount();
+    const qint64 secondNs = timer.nsecsElapsed();
+
+    qDebug() << "Upgradeable:" << first << "(solver:" << firstNs / 1000 << "us,"
+             << "cached:" << secondNs / 1000 << "us)";
+
+    if (first != second) {
+        qWarning() << "FAIL: cached result differs:" << first << "vs" << second;
+        ret = 1;
+    }
+
+    // reopening the database must invalidate the cache
+    //    and give the same answer again
+    db.close();
+    if (!db.open(QtApk::QTAPK_OPENF_READONLY)) {
+        qWarning() << "Failed to reopen APK DB!";
+        return 1;
+    }
+    const int third = db.upgradeablePackagesCount();
+    if (third != first) {
+        qWarning() << "FAIL: result after reopen differs:" << first << "vs" << third;
+        ret = 1;
+    }
+
+    db.close();
+    return ret;
+}
@@ -0,0 +1,88 @@
+#!/bin/sh
+# Regenerates the small signed repository in localrepo/, served over
+#    loopback HTTP by test_prefetch. Generated files are committed, so
+#    this only has to be run when the repository contents change.
+# Needs GNU tar, gzip, openssl, sha1sum, base64.
+
+SCRIPT_DIR=$(realpath $(dirname $0) )
+REPO_DIR=$SCRIPT_DIR/localrepo
+ARCH=x86_64
+KEY=$REPO_DIR/qtapk-test.rsa
+KEY_NAME=qtapk-test.rsa.pub
+TMP=$(mktemp -d) || exit 1
+
+TAR="tar --format=ustar --owner=0 --group=0 --numeric-owner --mtime=@1600000000"
+
+# tar archive without end-of-archive blocks, so that the next gzip
+#    stream continues the same tar stream (same as "abuild-tar --cut")
+tar_cut() {
+    # $1 - dir, $2 - single file name in it
+    local size=$(stat -c %s "$1/$2")
+    ( cd "$1" && $TAR -cf - "$2" ) | head -c $(( 512 + (size + 511) / 512 * 512 ))
+}
+
+# $1 - name, $2 - version, $3 - depends
+make_package() {
+    local dir=$TMP/$1
+    mkdir -p $dir/data
+    cat > $dir/.PKGINFO <<EOF
+pkgname = $1
+pkgver = $2
+pkgdesc = QtApk test package $1
+url = https://gitlab.com/postmarketOS/libapk-qt
+builddate = 1600000000
+size = 4096
+arch = noarch
+license = GPL-2.0-or-later
+origin = qtapk-test
+EOF
+    if [ -n "$3" ]; then
+        echo "depend = $3" >> $dir/.PKGINFO
+    fi
+    tar_cut $dir .PKGINFO | gzip -9n > $dir/control.tar.gz
+    # package has no files, data part is an empty tar archive
+    ( cd $dir/data && $TAR -cf - --files-from /dev/null ) | gzip -9n > $dir/data.tar.gz
+    cat $dir/control.tar.gz $dir/data.tar.gz > $REPO_DIR/$ARCH/$1-$2.apk
+
+    local csum=$(sha1sum $dir/control.tar.gz | cut -d' ' -f1 | xxd -r -p | base64)
+    local apksize=$(stat -c %s $REPO_DIR/$ARCH/$1-$2.apk)
+    cat >> $TMP/APKINDEX <<EOF
+C:Q1$csum
+P:$1
+V:$2
+A:noarch
+S:$apksize
+I:4096
+T:QtApk test package $1
+U:https://gitlab.com/postmarketOS/libapk-qt
+L:GPL-2.0-or-later
+o:qtapk-test
+t:1600000000
+EOF
+    if [ -n "$3" ]; then
+        echo "D:$3" >> $TMP/APKINDEX
+    fi
+    echo >> $TMP/APKINDEX
+}
+
+mkdir -p $REPO_DIR/$ARCH || exit 1
+rm -f $REPO_DIR/$ARCH/*
+if [ ! -f $KEY ]; then
+    openssl genrsa -out $KEY 2048 || exit 1
+fi
+openssl rsa -in $KEY -pubout -out $SCRIPT_DIR/files/$KEY_NAME || exit 1
+
+: > $TMP/APKINDEX
+make_package qtapk-test-data 1.0-r0
+make_package qtapk-test 1.0-r0 qtapk-test-data
+
+echo "qtapk-test" > $TMP/DESCRIPTION
+( cd $TMP && $TAR -cf - DESCRIPTION APKINDEX ) | gzip -9n > $TMP/index.tar.gz
+
+# same as "abuild-sign"
+mkdir -p $TMP/sign
+openssl dgst -sha1 -sign $KEY -out $TMP/sign/.SIGN.RSA.$KEY_NAME $TMP/index.tar.gz || exit 1
+tar_cut $TMP/sign .SIGN.RSA.$KEY_NAME | gzip -9n > $TMP/sign.tar.gz
+cat $TMP/sign.tar.gz $TMP/index.tar.gz > $REPO_DIR/$ARCH/APKINDEX.tar.gz
+
+rm -rf $TMP